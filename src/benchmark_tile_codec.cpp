@@ -0,0 +1,85 @@
+
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <json/json.h>
+#include "queries/operator_tree.h"
+#include "util/tile_codec.h"
+
+
+/**
+ * Measures the compression ratio and the throughput of the TileCodec, which is used by the compressed tile caches.
+ * Takes two input parameters: query file name and number of repeated decodings of every tile.
+ * The input operator of the consuming operator of the query is executed and every returned tile is encoded
+ * and decoded. The ratio of raw to encoded bytes and the encode and decode throughput in MB/s of the raw data
+ * are printed to std::cout. Every decoded tile is compared to the original one.
+ * E.g. run it with gdal_query_temp_month.json or gdal_query_leaf_area_index.json for the test datasets.
+ */
+int main(int argc, char** argv) {
+
+    using namespace rts;
+    using Clock = std::chrono::high_resolution_clock;
+
+    if(argc < 2) {
+        std::cout << "No query file provided in program arguments." << std::endl;
+        return 0;
+    }
+    int count = argc > 2 ? std::stoi(argv[2]) : 10;
+
+    std::ifstream file_in(argv[1]);
+    Json::Value json_query;
+    file_in >> json_query;
+
+    QueryRectangle qrect(json_query["query_rectangle"]);
+    OperatorTree operatorTree(json_query["sources"][0], qrect);
+    std::unique_ptr<GenericOperator> input = operatorTree.instantiate();
+    input->initializeRecursively();
+
+    size_t tiles = 0;
+    size_t rawBytes = 0;
+    size_t encodedBytes = 0;
+    std::chrono::duration<double> encodeTime(0);
+    std::chrono::duration<double> decodeTime(0);
+    std::vector<uint8_t> encoded;
+
+    while(auto desc = input->nextDescriptor()){
+        UniqueRaster raster = desc->getRaster();
+        size_t size = static_cast<size_t>(raster->getDataLength()) * raster->sizeOfDataType();
+
+        auto t1 = Clock::now();
+        TileCodec::encode(raster.get(), encoded);
+        auto t2 = Clock::now();
+        encodeTime += t2 - t1;
+
+        UniqueRaster decoded = Raster::createRaster(raster->getDataType(), raster->getResolution());
+        t1 = Clock::now();
+        for(int i = 0; i < count; ++i)
+            TileCodec::decode(encoded.data(), encoded.size(), decoded.get());
+        t2 = Clock::now();
+        decodeTime += t2 - t1;
+
+        if(std::memcmp(decoded->getVoidDataPointer(), raster->getVoidDataPointer(), size) != 0){
+            std::cout << "Decoded tile " << desc->tileIndex << " differs from the original tile." << std::endl;
+            return 1;
+        }
+
+        ++tiles;
+        rawBytes += size;
+        encodedBytes += encoded.size();
+    }
+
+    if(tiles == 0){
+        std::cout << "The query returned no tiles." << std::endl;
+        return 0;
+    }
+
+    double megabytes = static_cast<double>(rawBytes) / (1024 * 1024);
+    std::cout << "Tiles: " << tiles << "\n";
+    std::cout << "Raw bytes: " << rawBytes << ", encoded bytes: " << encodedBytes << "\n";
+    std::cout << "Compression ratio: " << static_cast<double>(rawBytes) / encodedBytes << "\n";
+    std::cout << "Encode throughput: " << megabytes / encodeTime.count() << " MB/s\n";
+    std::cout << "Decode throughput: " << megabytes * count / decodeTime.count() << " MB/s" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,65 @@
+
+#include <iostream>
+#include <vector>
+#include <gdal_priv.h>
+#include <boost/filesystem.hpp>
+#include "util/gdal_util.h"
+#include "util/dataset_catalog.h"
+
+
+/**
+ * Builds overviews for all files of a GDAL source dataset, so queries with a coarser resolution than the files
+ * read from the overviews. Takes the dataset name as first parameter, it is loaded from the DatasetCatalog
+ * like in the GDAL source. The optional second parameter is the resampling method used by GDAL, e.g. NEAREST
+ * or AVERAGE, default NEAREST. All further parameters are the overview levels, default 2 4 8 16.
+ * The overviews are written to a sibling .ovr file of every raster file, the raster files are not changed.
+ */
+int main(int argc, char** argv) {
+
+    using namespace rts;
+
+    if(argc < 2) {
+        std::cout << "No dataset name provided in program arguments." << std::endl;
+        return 0;
+    }
+
+    std::string resampling = argc > 2 ? argv[2] : "NEAREST";
+    std::vector<int> levels;
+    for(int i = 3; i < argc; ++i)
+        levels.push_back(std::stoi(argv[i]));
+    if(levels.empty())
+        levels = {2, 4, 8, 16};
+
+    std::shared_ptr<const CatalogDataset> catalogDataset;
+    try {
+        catalogDataset = DatasetCatalog::getGdalSourceDataset(argv[1]);
+    } catch(const std::exception &e) {
+        std::cout << e.what() << std::endl;
+        return 1;
+    }
+
+    GDALUtil::initGdal();
+    int channel = catalogDataset->json["channel"].asInt();
+
+    for(const DatasetFile &file : catalogDataset->files){
+        boost::filesystem::path filePath(file.path);
+
+        //opened read only, GDAL writes the overviews to a sibling .ovr file.
+        auto dataset = (GDALDataset *)GDALOpen(filePath.c_str(), GA_ReadOnly);
+        if(dataset == nullptr) {
+            std::cout << "GDAL dataset could not be opened: " << filePath.string() << std::endl;
+            return 1;
+        }
+
+        auto res = dataset->BuildOverviews(resampling.c_str(), static_cast<int>(levels.size()), levels.data(),
+                                           1, &channel, nullptr, nullptr);
+        GDALClose(dataset);
+        if(res != CE_None) {
+            std::cout << "Building overviews failed: " << filePath.string() << std::endl;
+            return 1;
+        }
+        std::cout << "Built overviews: " << filePath.string() << std::endl;
+    }
+
+    return 0;
+}
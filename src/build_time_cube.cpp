@@ -0,0 +1,88 @@
+
+#include <iostream>
+#include <fstream>
+#include <map>
+#include <json/json.h>
+#include <boost/filesystem.hpp>
+#include "queries/operator_tree.h"
+#include "util/raster_calculations.h"
+#include "util/dataset_catalog.h"
+#include "util/time_cube.h"
+
+
+/**
+ * Converts the result of a query to a time cube file, the native storage format that is read by the time_cube source
+ * backend without decoding. Takes three parameters: query file name, dataset name and optionally the number of
+ * rasters per chunk of the cube, default 8.
+ * The input operator of the consuming operator of the query is executed twice, once for finding the times of the
+ * rasters and once for writing the tiles. The cube is written to <root>/time_cube/<dataset>.cube, with the root of
+ * the DatasetCatalog. It can be read by queries with the same pixel size and tile resolution as the converted query.
+ * The tiles are positioned with the origin of the projection of the query.
+ */
+int main(int argc, char** argv) {
+
+    using namespace rts;
+
+    if(argc < 3) {
+        std::cout << "No query file and dataset name provided in program arguments." << std::endl;
+        return 0;
+    }
+    uint32_t chunkTimesteps = argc > 3 ? static_cast<uint32_t>(std::stoul(argv[3])) : 8;
+
+    std::ifstream file_in(argv[1]);
+    Json::Value json_query;
+    file_in >> json_query;
+    QueryRectangle qrect(json_query["query_rectangle"]);
+
+    try {
+        TimeCubeLayout layout;
+        layout.chunkTimesteps = std::max<uint32_t>(1, chunkTimesteps);
+        std::map<double, double> times;
+        {
+            OperatorTree operatorTree(json_query["sources"][0], qrect);
+            std::unique_ptr<GenericOperator> input = operatorTree.instantiate();
+            input->initializeRecursively();
+            while(auto desc = input->nextDescriptor()){
+                times[desc->rasterInfo.t1] = desc->rasterInfo.t2;
+                layout.dataType = desc->dataType;
+                layout.nodata = desc->nodata;
+                layout.tileRes = desc->tileResolution;
+                layout.tileCount = desc->rasterTileCountDimensional;
+            }
+        }
+        if(times.empty()){
+            std::cout << "The query returned no tiles." << std::endl;
+            return 1;
+        }
+        for(auto &time : times)
+            layout.times.emplace_back(time.first, time.second);
+
+        layout.origin = qrect.projection.getOrigin();
+        layout.scale = Scale((qrect.x2 - qrect.x1) / qrect.resX, (qrect.y2 - qrect.y1) / qrect.resY);
+        Resolution rasterWorldPixelStart = RasterCalculations::coordinateToPixel(layout.scale, layout.origin, qrect.x1, qrect.y1);
+        layout.firstTile = Resolution(rasterWorldPixelStart.resX / layout.tileRes.resX, rasterWorldPixelStart.resY / layout.tileRes.resY);
+
+        boost::filesystem::path path(DatasetCatalog::getRoot());
+        path /= "time_cube";
+        boost::filesystem::create_directories(path);
+        path /= std::string(argv[2]) + ".cube";
+        TimeCubeWriter writer(path.string(), layout);
+
+        OperatorTree operatorTree(json_query["sources"][0], qrect);
+        std::unique_ptr<GenericOperator> input = operatorTree.instantiate();
+        input->initializeRecursively();
+        size_t tiles = 0;
+        while(auto desc = input->nextDescriptor()){
+            UniqueRaster raster = desc->getRaster();
+            writer.write(static_cast<uint32_t>(desc->tileIndex), static_cast<uint32_t>(layout.findTime(desc->rasterInfo.t1)), raster.get());
+            ++tiles;
+        }
+
+        std::cout << "Wrote " << tiles << " tiles of " << layout.times.size() << " rasters to " << path.string() << std::endl;
+    } catch(const std::exception &e) {
+        std::cout << "Converting the query failed: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,55 @@
+
+#include "datatypes/accumulator.h"
+#include "datatypes/quantile_accumulator.h"
+
+using namespace rts;
+
+size_t Accumulator::bytesPerPixel(AggregatorFunction function, GDALDataType inputType, const AccumulatorOptions &options) {
+    if(function == AggregatorFunction::Quantile){
+        //histogram and count, minimum and maximum value, or the sample and the count.
+        if(inputType == GDT_Byte || inputType == GDT_UInt16 || inputType == GDT_Int16)
+            return (static_cast<size_t>(options.histogramBins) + 3) * sizeof(uint32_t);
+        else
+            return static_cast<size_t>(options.sampleSize) * sizeof(double) + sizeof(uint32_t);
+    }
+    //the accumulated value and the count.
+    return sizeof(int64_t) + sizeof(uint32_t);
+}
+
+Accumulator::Accumulator(AggregatorFunction function, const Resolution &res)
+        : function(function), res(res), data_length(res.resX * res.resY)
+{
+
+}
+
+AggregatorFunction Accumulator::getFunction() const {
+    return function;
+}
+
+Resolution Accumulator::getResolution() const {
+    return res;
+}
+
+std::unique_ptr<Accumulator> Accumulator::createAccumulator(AggregatorFunction function, GDALDataType inputType, const Resolution &res,
+                                                            const AccumulatorOptions &options) {
+    if(function == AggregatorFunction::Quantile){
+        if(inputType == GDT_Byte || inputType == GDT_UInt16 || inputType == GDT_Int16)
+            return std::make_unique<HistogramQuantileAccumulator>(res, inputType, options);
+        else
+            return std::make_unique<SampleQuantileAccumulator>(res, options);
+    }
+
+    switch(inputType){
+        case GDT_Byte:
+        case GDT_UInt16:
+        case GDT_Int16:
+        case GDT_UInt32:
+        case GDT_Int32:
+            return std::make_unique<TypedAccumulator<int64_t>>(function, res);
+        case GDT_Float32:
+        case GDT_Float64:
+            return std::make_unique<TypedAccumulator<double>>(function, res);
+        default:
+            throw std::runtime_error("Unsupported data type for accumulator creation.");
+    }
+}
@@ -0,0 +1,306 @@
+
+#ifndef RASTER_TIME_SERIES_ACCUMULATOR_H
+#define RASTER_TIME_SERIES_ACCUMULATOR_H
+
+#include <vector>
+#include <memory>
+#include <limits>
+#include <cmath>
+#include "datatypes/raster.h"
+#include "datatypes/raster_operations.h"
+
+namespace rts {
+
+    enum class AggregatorFunction {
+        Mean,
+        Min,
+        Max,
+        Sum,
+        Quantile
+    };
+
+    /**
+     * Settings for accumulators that are not defined by the aggregation function alone.
+     */
+    struct AccumulatorOptions {
+        /**
+         * The quantile in [0,1] calculated by the Quantile function, 0.5 is the median.
+         */
+        double quantile = 0.5;
+
+        /**
+         * Number of histogram bins per pixel used by the Quantile function for Byte, Int16, and UInt16 inputs.
+         * The bins cover the whole value range of the data type, so 256 bins are exact for Byte inputs.
+         */
+        uint32_t histogramBins = 256;
+
+        /**
+         * Number of values per pixel kept in a random sample by the Quantile function for all other input types.
+         */
+        uint32_t sampleSize = 64;
+    };
+
+    /**
+     * Base type for accumulating the cells of multiple rasters into one result, e.g. for temporal aggregation.
+     * The accumulated values are not stored in the data type of the output raster but in a wide type (int64 for
+     * integer inputs, double for floating point inputs) together with a per-pixel count of the valid (not nodata) values
+     * that were added. So adding a raster is a single operation per pixel and the mean is only divided once
+     * when finalize() writes the result into the output raster.
+     * The actual data is stored in the generic sub type TypedAccumulator.
+     * The Quantile function uses the bounded memory sub types from quantile_accumulator.h instead.
+     */
+    class Accumulator {
+    public:
+        /**
+         * Creates a TypedAccumulator with an accumulation type fitting for the data type of the input rasters.
+         * @param function The aggregation function that is applied when adding rasters.
+         * @param inputType Data type of the rasters that will be added.
+         * @param res Resolution of the added rasters.
+         * @param options Settings used by some of the functions.
+         * @return unique ptr of the base class.
+         */
+        static std::unique_ptr<Accumulator> createAccumulator(AggregatorFunction function, GDALDataType inputType, const Resolution &res,
+                                                              const AccumulatorOptions &options = AccumulatorOptions());
+
+        /**
+         * @return The memory per pixel of the accumulator createAccumulator() returns for the parameters, in bytes.
+         */
+        static size_t bytesPerPixel(AggregatorFunction function, GDALDataType inputType, const AccumulatorOptions &options = AccumulatorOptions());
+
+        Accumulator(AggregatorFunction function, const Resolution &res);
+        virtual ~Accumulator() = default;
+        Accumulator(const Accumulator &other) = delete;
+        Accumulator& operator=(const Accumulator &other) = delete;
+
+        /**
+         * Adds all valid cells of the raster to the accumulated values.
+         * @param raster Raster with the same resolution as the accumulator.
+         * @param nodata The nodata value of the raster, those cells are ignored.
+         */
+        virtual void add(Raster *raster, double nodata) = 0;
+
+        /**
+         * Merges the accumulated values of another accumulator into this one. Both must have been created
+         * with the same function and input data type.
+         */
+        virtual void merge(const Accumulator &other) = 0;
+
+        /**
+         * Calculates the result of the aggregation and writes it into the output raster.
+         * @param out Raster with the same resolution as the accumulator, can be of any data type.
+         * @param nodata Value written to cells that did not get a single valid value.
+         */
+        virtual void finalize(Raster *out, double nodata) const = 0;
+
+        /**
+         * Resets the accumulator to the state after construction.
+         */
+        virtual void clear() = 0;
+
+        AggregatorFunction getFunction() const;
+        Resolution getResolution() const;
+
+    protected:
+        AggregatorFunction function;
+        Resolution res;
+        int data_length;
+    };
+    using UniqueAccumulator = std::unique_ptr<Accumulator>;
+
+    /**
+     * Accumulator for the functions Mean, Min, Max, and Sum, storing the accumulated values in type A.
+     * @tparam A The wide type the values are accumulated in.
+     */
+    template<class A>
+    class TypedAccumulator : public Accumulator {
+    public:
+        TypedAccumulator(AggregatorFunction function, const Resolution &res);
+        void add(Raster *raster, double nodata) override;
+        void merge(const Accumulator &other) override;
+        void finalize(Raster *out, double nodata) const override;
+        void clear() override;
+
+        template<class T>
+        void addTyped(TypedRaster<T> *raster, double nodata);
+        template<class T>
+        void finalizeTyped(TypedRaster<T> *out, double nodata) const;
+    private:
+        std::vector<A> values;
+        std::vector<uint32_t> counts;
+    };
+
+    /**
+     * Checks if a cell value is valid, meaning it is neither the nodata value nor NaN.
+     */
+    template<class T>
+    inline bool isValidCell(T value, T nodata) {
+        //value == value is only false for NaN.
+        return value != nodata && (!std::numeric_limits<T>::has_quiet_NaN || value == value);
+    }
+
+    /**
+     * Casts a value into the cell type T. Values outside of the range of T are clamped to its lowest or highest value,
+     * because casting them is undefined behaviour. Infinity is kept for floating point types.
+     * @param nanValue Returned for NaN if T can not represent NaN.
+     */
+    template<class T>
+    inline T clampedCast(double value, T nanValue) {
+        if(value != value)
+            return std::numeric_limits<T>::has_quiet_NaN ? static_cast<T>(value) : nanValue;
+        if(std::numeric_limits<T>::has_infinity && std::isinf(value))
+            return static_cast<T>(value);
+        if(value < static_cast<double>(std::numeric_limits<T>::lowest()))
+            return std::numeric_limits<T>::lowest();
+        if(value > static_cast<double>(std::numeric_limits<T>::max()))
+            return std::numeric_limits<T>::max();
+        return static_cast<T>(value);
+    }
+
+    /**
+     * Unary raster operation used to call addTyped of an accumulator sub type with the actual type of the input raster.
+     */
+    template<class T>
+    struct AccumulatorAddOperation {
+        template<class Acc>
+        static void rasterOperation(TypedRaster<T> *raster, Acc *accumulator, double nodata) {
+            accumulator->addTyped(raster, nodata);
+        }
+    };
+
+    /**
+     * Unary raster operation used to call finalizeTyped of an accumulator sub type with the actual type of the output raster.
+     */
+    template<class T>
+    struct AccumulatorFinalizeOperation {
+        template<class Acc>
+        static void rasterOperation(TypedRaster<T> *out, const Acc *accumulator, double nodata) {
+            accumulator->finalizeTyped(out, nodata);
+        }
+    };
+
+    template<class A>
+    TypedAccumulator<A>::TypedAccumulator(AggregatorFunction function, const Resolution &res)
+            : Accumulator(function, res), values(data_length, 0), counts(data_length, 0)
+    {
+        if(function == AggregatorFunction::Quantile)
+            throw std::runtime_error("Accumulator: quantiles are not supported by TypedAccumulator.");
+    }
+
+    template<class A>
+    void TypedAccumulator<A>::add(Raster *raster, double nodata) {
+        if(raster->getDataLength() != data_length)
+            throw std::runtime_error("Accumulator: added raster does not match the resolution of the accumulator.");
+        RasterOperations::callUnary<AccumulatorAddOperation>(raster, this, nodata);
+    }
+
+    template<class A>
+    void TypedAccumulator<A>::finalize(Raster *out, double nodata) const {
+        if(out->getDataLength() != data_length)
+            throw std::runtime_error("Accumulator: output raster does not match the resolution of the accumulator.");
+        RasterOperations::callUnary<AccumulatorFinalizeOperation>(out, this, nodata);
+    }
+
+    template<class A>
+    void TypedAccumulator<A>::clear() {
+        std::fill(values.begin(), values.end(), 0);
+        std::fill(counts.begin(), counts.end(), 0);
+    }
+
+    template<class A>
+    template<class T>
+    void TypedAccumulator<A>::addTyped(TypedRaster<T> *raster, double nodata) {
+        const T *in = raster->getDataPointer();
+        const T nodataTyped = static_cast<T>(nodata);
+        A *val = values.data();
+        uint32_t *count = counts.data();
+
+        //switch once per raster instead of once per pixel.
+        switch(function){
+            case AggregatorFunction::Mean:
+            case AggregatorFunction::Sum:
+                for(int i = 0; i < data_length; ++i){
+                    if(isValidCell(in[i], nodataTyped)){
+                        val[i] += static_cast<A>(in[i]);
+                        count[i] += 1;
+                    }
+                }
+                break;
+            case AggregatorFunction::Min:
+                for(int i = 0; i < data_length; ++i){
+                    if(isValidCell(in[i], nodataTyped)){
+                        auto v = static_cast<A>(in[i]);
+                        if(count[i] == 0 || v < val[i])
+                            val[i] = v;
+                        count[i] += 1;
+                    }
+                }
+                break;
+            case AggregatorFunction::Max:
+                for(int i = 0; i < data_length; ++i){
+                    if(isValidCell(in[i], nodataTyped)){
+                        auto v = static_cast<A>(in[i]);
+                        if(count[i] == 0 || v > val[i])
+                            val[i] = v;
+                        count[i] += 1;
+                    }
+                }
+                break;
+            case AggregatorFunction::Quantile:
+                break;
+        }
+    }
+
+    template<class A>
+    void TypedAccumulator<A>::merge(const Accumulator &other) {
+        auto *typedOther = dynamic_cast<const TypedAccumulator<A>*>(&other);
+        if(typedOther == nullptr || typedOther->function != function || typedOther->data_length != data_length)
+            throw std::runtime_error("Accumulator: can not merge accumulators of different types.");
+
+        for(int i = 0; i < data_length; ++i){
+            uint32_t otherCount = typedOther->counts[i];
+            if(otherCount == 0)
+                continue;
+            A otherVal = typedOther->values[i];
+            switch(function){
+                case AggregatorFunction::Mean:
+                case AggregatorFunction::Sum:
+                    values[i] += otherVal;
+                    break;
+                case AggregatorFunction::Min:
+                    if(counts[i] == 0 || otherVal < values[i])
+                        values[i] = otherVal;
+                    break;
+                case AggregatorFunction::Max:
+                    if(counts[i] == 0 || otherVal > values[i])
+                        values[i] = otherVal;
+                    break;
+                case AggregatorFunction::Quantile:
+                    break;
+            }
+            counts[i] += otherCount;
+        }
+    }
+
+    template<class A>
+    template<class T>
+    void TypedAccumulator<A>::finalizeTyped(TypedRaster<T> *out, double nodata) const {
+        T *outData = out->getDataPointer();
+        const T nodataTyped = static_cast<T>(nodata);
+
+        if(function == AggregatorFunction::Mean){
+            for(int i = 0; i < data_length; ++i){
+                if(counts[i] == 0)
+                    outData[i] = nodataTyped;
+                else
+                    outData[i] = clampedCast<T>(static_cast<double>(values[i]) / counts[i], nodataTyped);
+            }
+        } else {
+            for(int i = 0; i < data_length; ++i){
+                outData[i] = counts[i] == 0 ? nodataTyped : clampedCast<T>(static_cast<double>(values[i]), nodataTyped);
+            }
+        }
+    }
+
+}
+
+#endif //RASTER_TIME_SERIES_ACCUMULATOR_H
@@ -0,0 +1,169 @@
+
+#include "datatypes/quantile_accumulator.h"
+
+using namespace rts;
+
+HistogramQuantileAccumulator::HistogramQuantileAccumulator(const Resolution &res, GDALDataType inputType, const AccumulatorOptions &options)
+        : Accumulator(AggregatorFunction::Quantile, res), quantile(options.quantile), bins(options.histogramBins)
+{
+    if(bins == 0)
+        throw std::runtime_error("HistogramQuantileAccumulator: number of bins must be greater than 0.");
+
+    double valueRange;
+    switch(inputType){
+        case GDT_Byte:
+            valueMin = 0;
+            valueRange = 256;
+            break;
+        case GDT_UInt16:
+            valueMin = 0;
+            valueRange = 65536;
+            break;
+        case GDT_Int16:
+            valueMin = -32768;
+            valueRange = 65536;
+            break;
+        default:
+            throw std::runtime_error("HistogramQuantileAccumulator: only Byte, UInt16, and Int16 are supported.");
+    }
+    bins = std::min(bins, static_cast<uint32_t>(valueRange));
+    binWidth = valueRange / bins;
+    histograms.resize(static_cast<size_t>(data_length) * bins, 0);
+    counts.resize(data_length, 0);
+    minValues.resize(data_length, 0);
+    maxValues.resize(data_length, 0);
+}
+
+void HistogramQuantileAccumulator::add(Raster *raster, double nodata) {
+    if(raster->getDataLength() != data_length)
+        throw std::runtime_error("Accumulator: added raster does not match the resolution of the accumulator.");
+    RasterOperations::callUnary<AccumulatorAddOperation>(raster, this, nodata);
+}
+
+void HistogramQuantileAccumulator::merge(const Accumulator &other) {
+    auto *histOther = dynamic_cast<const HistogramQuantileAccumulator*>(&other);
+    if(histOther == nullptr || histOther->bins != bins || histOther->valueMin != valueMin || histOther->data_length != data_length)
+        throw std::runtime_error("Accumulator: can not merge accumulators of different types.");
+
+    for(size_t i = 0; i < histograms.size(); ++i){
+        histograms[i] += histOther->histograms[i];
+    }
+    for(int i = 0; i < data_length; ++i){
+        if(histOther->counts[i] == 0)
+            continue;
+        if(counts[i] == 0 || histOther->minValues[i] < minValues[i])
+            minValues[i] = histOther->minValues[i];
+        if(counts[i] == 0 || histOther->maxValues[i] > maxValues[i])
+            maxValues[i] = histOther->maxValues[i];
+        counts[i] += histOther->counts[i];
+    }
+}
+
+void HistogramQuantileAccumulator::finalize(Raster *out, double nodata) const {
+    if(out->getDataLength() != data_length)
+        throw std::runtime_error("Accumulator: output raster does not match the resolution of the accumulator.");
+    RasterOperations::callUnary<AccumulatorFinalizeOperation>(out, this, nodata);
+}
+
+void HistogramQuantileAccumulator::clear() {
+    std::fill(histograms.begin(), histograms.end(), 0);
+    std::fill(counts.begin(), counts.end(), 0);
+}
+
+double HistogramQuantileAccumulator::valueAtRank(int pixel, uint32_t rank) const {
+    const uint32_t *histogram = histograms.data() + static_cast<size_t>(pixel) * bins;
+    uint32_t before = 0;
+    for(uint32_t b = 0; b < bins; ++b){
+        uint32_t binCount = histogram[b];
+        if(before + binCount > rank){
+            double binStart = valueMin + b * binWidth;
+            if(binWidth <= 1)
+                return binStart;
+            //assume the values are spread evenly over the part of the bin between the smallest and largest value.
+            double low  = std::max(binStart, static_cast<double>(minValues[pixel]));
+            double high = std::min(binStart + binWidth - 1, static_cast<double>(maxValues[pixel]));
+            if(binCount == 1)
+                return (low + high) / 2;
+            return low + (high - low) * (rank - before) / (binCount - 1);
+        }
+        before += binCount;
+    }
+    return maxValues[pixel];
+}
+
+SampleQuantileAccumulator::SampleQuantileAccumulator(const Resolution &res, const AccumulatorOptions &options)
+        : Accumulator(AggregatorFunction::Quantile, res), quantile(options.quantile), sampleSize(options.sampleSize), random(42)
+{
+    if(sampleSize == 0)
+        throw std::runtime_error("SampleQuantileAccumulator: sample size must be greater than 0.");
+    samples.resize(static_cast<size_t>(data_length) * sampleSize, 0);
+    counts.resize(data_length, 0);
+}
+
+void SampleQuantileAccumulator::add(Raster *raster, double nodata) {
+    if(raster->getDataLength() != data_length)
+        throw std::runtime_error("Accumulator: added raster does not match the resolution of the accumulator.");
+    RasterOperations::callUnary<AccumulatorAddOperation>(raster, this, nodata);
+}
+
+void SampleQuantileAccumulator::merge(const Accumulator &other) {
+    auto *sampleOther = dynamic_cast<const SampleQuantileAccumulator*>(&other);
+    if(sampleOther == nullptr || sampleOther->sampleSize != sampleSize || sampleOther->data_length != data_length)
+        throw std::runtime_error("Accumulator: can not merge accumulators of different types.");
+
+    std::vector<double> ownSample(sampleSize);
+    std::vector<double> otherSample(sampleSize);
+    for(int i = 0; i < data_length; ++i){
+        uint32_t ownCount = counts[i];
+        uint32_t otherCount = sampleOther->counts[i];
+        if(otherCount == 0)
+            continue;
+
+        double *target = samples.data() + static_cast<size_t>(i) * sampleSize;
+        const double *source = sampleOther->samples.data() + static_cast<size_t>(i) * sampleSize;
+        uint32_t ownLength = std::min(ownCount, sampleSize);
+        uint32_t otherLength = std::min(otherCount, sampleSize);
+
+        if(ownLength + otherLength <= sampleSize){
+            std::copy(source, source + otherLength, target + ownLength);
+        } else {
+            //decide for every entry of the merged sample from which sample it is taken,
+            //weighted by the number of values the samples represent.
+            uint32_t takeOwn = 0, takeOther = 0;
+            uint64_t ownLeft = ownCount, otherLeft = otherCount;
+            for(uint32_t k = 0; k < sampleSize; ++k){
+                if(std::uniform_int_distribution<uint64_t>(0, ownLeft + otherLeft - 1)(random) < ownLeft){
+                    ++takeOwn;
+                    --ownLeft;
+                } else {
+                    ++takeOther;
+                    --otherLeft;
+                }
+            }
+            std::copy(target, target + ownLength, ownSample.begin());
+            std::copy(source, source + otherLength, otherSample.begin());
+            //partial Fisher-Yates shuffle to pick random entries of both samples.
+            for(uint32_t k = 0; k < takeOwn; ++k){
+                uint32_t pos = std::uniform_int_distribution<uint32_t>(k, ownLength - 1)(random);
+                std::swap(ownSample[k], ownSample[pos]);
+                target[k] = ownSample[k];
+            }
+            for(uint32_t k = 0; k < takeOther; ++k){
+                uint32_t pos = std::uniform_int_distribution<uint32_t>(k, otherLength - 1)(random);
+                std::swap(otherSample[k], otherSample[pos]);
+                target[takeOwn + k] = otherSample[k];
+            }
+        }
+        counts[i] = ownCount + otherCount;
+    }
+}
+
+void SampleQuantileAccumulator::finalize(Raster *out, double nodata) const {
+    if(out->getDataLength() != data_length)
+        throw std::runtime_error("Accumulator: output raster does not match the resolution of the accumulator.");
+    RasterOperations::callUnary<AccumulatorFinalizeOperation>(out, this, nodata);
+}
+
+void SampleQuantileAccumulator::clear() {
+    std::fill(counts.begin(), counts.end(), 0);
+}
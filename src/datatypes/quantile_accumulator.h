@@ -0,0 +1,157 @@
+
+#ifndef RASTER_TIME_SERIES_QUANTILE_ACCUMULATOR_H
+#define RASTER_TIME_SERIES_QUANTILE_ACCUMULATOR_H
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "datatypes/accumulator.h"
+
+namespace rts {
+
+    /**
+     * Accumulator for the Quantile function on Byte, Int16, and UInt16 inputs. Every pixel has a histogram of
+     * AccumulatorOptions::histogramBins bins covering the whole value range of the input data type, so the memory is
+     * fixed at resolution * (bins + 3) * 4 bytes, independent of the number of added rasters.
+     * When a bin covers multiple values, the quantile is interpolated inside of the bin, bounded by the smallest and
+     * largest value of the pixel.
+     */
+    class HistogramQuantileAccumulator : public Accumulator {
+    public:
+        HistogramQuantileAccumulator(const Resolution &res, GDALDataType inputType, const AccumulatorOptions &options);
+        void add(Raster *raster, double nodata) override;
+        void merge(const Accumulator &other) override;
+        void finalize(Raster *out, double nodata) const override;
+        void clear() override;
+
+        template<class T>
+        void addTyped(TypedRaster<T> *raster, double nodata);
+        template<class T>
+        void finalizeTyped(TypedRaster<T> *out, double nodata) const;
+    private:
+        /**
+         * @return The value of the pixel with the passed rank, 0 is the smallest value.
+         */
+        double valueAtRank(int pixel, uint32_t rank) const;
+
+        double quantile;
+        uint32_t bins;
+        double valueMin;
+        double binWidth;
+        std::vector<uint32_t> histograms;
+        std::vector<uint32_t> counts;
+        std::vector<int32_t> minValues;
+        std::vector<int32_t> maxValues;
+    };
+
+    /**
+     * Accumulator for the Quantile function on all input types. Every pixel keeps a uniform random sample
+     * (reservoir sampling) of AccumulatorOptions::sampleSize of its valid values, the quantile of the sample is the result.
+     * The memory is fixed at resolution * sampleSize * 8 bytes. Up to sampleSize values per pixel the result is exact.
+     * The random generator has a fixed seed, so results are reproducible for the same order of added rasters.
+     */
+    class SampleQuantileAccumulator : public Accumulator {
+    public:
+        SampleQuantileAccumulator(const Resolution &res, const AccumulatorOptions &options);
+        void add(Raster *raster, double nodata) override;
+        void merge(const Accumulator &other) override;
+        void finalize(Raster *out, double nodata) const override;
+        void clear() override;
+
+        template<class T>
+        void addTyped(TypedRaster<T> *raster, double nodata);
+        template<class T>
+        void finalizeTyped(TypedRaster<T> *out, double nodata) const;
+    private:
+        double quantile;
+        uint32_t sampleSize;
+        std::vector<double> samples;
+        std::vector<uint32_t> counts;
+        std::mt19937 random;
+    };
+
+    template<class T>
+    void HistogramQuantileAccumulator::addTyped(TypedRaster<T> *raster, double nodata) {
+        const T *in = raster->getDataPointer();
+        const T nodataTyped = static_cast<T>(nodata);
+        for(int i = 0; i < data_length; ++i){
+            if(isValidCell(in[i], nodataTyped)){
+                auto bin = static_cast<uint32_t>((static_cast<double>(in[i]) - valueMin) / binWidth);
+                histograms[static_cast<size_t>(i) * bins + std::min(bin, bins - 1)] += 1;
+                auto v = static_cast<int32_t>(in[i]);
+                if(counts[i] == 0 || v < minValues[i])
+                    minValues[i] = v;
+                if(counts[i] == 0 || v > maxValues[i])
+                    maxValues[i] = v;
+                counts[i] += 1;
+            }
+        }
+    }
+
+    template<class T>
+    void HistogramQuantileAccumulator::finalizeTyped(TypedRaster<T> *out, double nodata) const {
+        T *outData = out->getDataPointer();
+        const T nodataTyped = static_cast<T>(nodata);
+        for(int i = 0; i < data_length; ++i){
+            if(counts[i] == 0){
+                outData[i] = nodataTyped;
+                continue;
+            }
+            //linear interpolation between the two values closest to the quantile.
+            double rank = quantile * (counts[i] - 1);
+            auto lower = static_cast<uint32_t>(rank);
+            double lowerValue = valueAtRank(i, lower);
+            double result = lowerValue;
+            if(rank > lower)
+                result += (rank - lower) * (valueAtRank(i, lower + 1) - lowerValue);
+            outData[i] = clampedCast<T>(result, nodataTyped);
+        }
+    }
+
+    template<class T>
+    void SampleQuantileAccumulator::addTyped(TypedRaster<T> *raster, double nodata) {
+        const T *in = raster->getDataPointer();
+        const T nodataTyped = static_cast<T>(nodata);
+        for(int i = 0; i < data_length; ++i){
+            if(!isValidCell(in[i], nodataTyped))
+                continue;
+            uint32_t seen = counts[i];
+            if(seen < sampleSize){
+                samples[static_cast<size_t>(i) * sampleSize + seen] = static_cast<double>(in[i]);
+            } else {
+                //the new value replaces a random sample with probability sampleSize / (seen + 1).
+                uint32_t pos = std::uniform_int_distribution<uint32_t>(0, seen)(random);
+                if(pos < sampleSize)
+                    samples[static_cast<size_t>(i) * sampleSize + pos] = static_cast<double>(in[i]);
+            }
+            counts[i] = seen + 1;
+        }
+    }
+
+    template<class T>
+    void SampleQuantileAccumulator::finalizeTyped(TypedRaster<T> *out, double nodata) const {
+        T *outData = out->getDataPointer();
+        const T nodataTyped = static_cast<T>(nodata);
+        std::vector<double> sorted(sampleSize);
+        for(int i = 0; i < data_length; ++i){
+            uint32_t length = std::min(counts[i], sampleSize);
+            if(length == 0){
+                outData[i] = nodataTyped;
+                continue;
+            }
+            auto begin = samples.begin() + static_cast<size_t>(i) * sampleSize;
+            std::copy(begin, begin + length, sorted.begin());
+            std::sort(sorted.begin(), sorted.begin() + length);
+
+            double rank = quantile * (length - 1);
+            auto lower = static_cast<uint32_t>(rank);
+            double result = sorted[lower];
+            if(rank > lower)
+                result += (rank - lower) * (sorted[lower + 1] - sorted[lower]);
+            outData[i] = clampedCast<T>(result, nodataTyped);
+        }
+    }
+
+}
+
+#endif //RASTER_TIME_SERIES_QUANTILE_ACCUMULATOR_H
@@ -264,8 +264,8 @@ namespace rts {
     template<class T>
     void *TypedRaster<T>::getVoidDataPointerOffset(int offsetX, int offsetY) {
         T* offset_ptr = data;
-        offset_ptr += offsetY * res_x * sizeof(T);
-        offset_ptr += offsetX * sizeof(T);
+        offset_ptr += offsetY * res_x;
+        offset_ptr += offsetX;
         return static_cast<void*>(offset_ptr);
     }
 
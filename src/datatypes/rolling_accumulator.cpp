@@ -0,0 +1,33 @@
+
+#include "datatypes/rolling_accumulator.h"
+
+using namespace rts;
+
+RollingAccumulator::RollingAccumulator(AggregatorFunction function, const Resolution &res)
+        : function(function), res(res), data_length(res.resX * res.resY), windowSize(0)
+{
+
+}
+
+uint32_t RollingAccumulator::getWindowSize() const {
+    return windowSize;
+}
+
+std::unique_ptr<RollingAccumulator> RollingAccumulator::createRollingAccumulator(AggregatorFunction function, GDALDataType inputType, const Resolution &res) {
+    if(function == AggregatorFunction::Quantile)
+        throw std::runtime_error("Quantiles are not supported for rolling aggregation.");
+
+    switch(inputType){
+        case GDT_Byte:
+        case GDT_UInt16:
+        case GDT_Int16:
+        case GDT_UInt32:
+        case GDT_Int32:
+            return std::make_unique<TypedRollingAccumulator<int64_t>>(function, res);
+        case GDT_Float32:
+        case GDT_Float64:
+            return std::make_unique<TypedRollingAccumulator<double>>(function, res);
+        default:
+            throw std::runtime_error("Unsupported data type for rolling accumulator creation.");
+    }
+}
@@ -0,0 +1,366 @@
+
+#ifndef RASTER_TIME_SERIES_ROLLING_ACCUMULATOR_H
+#define RASTER_TIME_SERIES_ROLLING_ACCUMULATOR_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <cmath>
+#include <type_traits>
+#include "datatypes/accumulator.h"
+
+namespace rts {
+
+    /**
+     * Accumulates the cells of a moving window of rasters. Rasters enter the window with add() and the oldest raster
+     * leaves it with removeOldest(), both update the accumulated values incrementally instead of re-aggregating the window.
+     * For Sum and Mean the leaving raster is subtracted, therefore the rasters of the window are kept. Floating point
+     * sums are compensated (Kahan-Babuska summation), so the rounding error does not grow with the number of rasters that
+     * entered and left the window. Infinite values are only counted per pixel and not added to the sum, so a pixel is
+     * finite again once they left the window.
+     * For Min and Max every pixel has a monotonic deque of the values that can still become the minimum/maximum of the window,
+     * so the rasters themselves are not needed after adding them.
+     * The actual data is stored in the generic sub type TypedRollingAccumulator.
+     */
+    class RollingAccumulator {
+    public:
+        /**
+         * Creates a TypedRollingAccumulator with an accumulation type fitting for the data type of the input rasters.
+         * @param function The aggregation function that is applied on the window.
+         * @param inputType Data type of the rasters that will be added.
+         * @param res Resolution of the added rasters.
+         * @return unique ptr of the base class.
+         */
+        static std::unique_ptr<RollingAccumulator> createRollingAccumulator(AggregatorFunction function, GDALDataType inputType, const Resolution &res);
+
+        RollingAccumulator(AggregatorFunction function, const Resolution &res);
+        virtual ~RollingAccumulator() = default;
+        RollingAccumulator(const RollingAccumulator &other) = delete;
+        RollingAccumulator& operator=(const RollingAccumulator &other) = delete;
+
+        /**
+         * Adds a raster as the newest raster of the window.
+         * @param raster Raster with the same resolution as the accumulator.
+         * @param nodata The nodata value of the raster, those cells are ignored.
+         */
+        virtual void add(UniqueRaster raster, double nodata) = 0;
+
+        /**
+         * Removes the oldest raster from the window. Does nothing when the window is empty.
+         */
+        virtual void removeOldest() = 0;
+
+        /**
+         * Calculates the result of the aggregation of the current window and writes it into the output raster.
+         * @param out Raster with the same resolution as the accumulator, can be of any data type.
+         * @param nodata Value written to cells that have no valid value in the window.
+         */
+        virtual void finalize(Raster *out, double nodata) const = 0;
+
+        /**
+         * @return The number of rasters in the window.
+         */
+        uint32_t getWindowSize() const;
+
+    protected:
+        AggregatorFunction function;
+        Resolution res;
+        int data_length;
+        uint32_t windowSize;
+    };
+    using UniqueRollingAccumulator = std::unique_ptr<RollingAccumulator>;
+
+    /**
+     * RollingAccumulator storing the accumulated values in type A.
+     * @tparam A The wide type the values are accumulated in.
+     */
+    template<class A>
+    class TypedRollingAccumulator : public RollingAccumulator {
+    public:
+        TypedRollingAccumulator(AggregatorFunction function, const Resolution &res);
+        void add(UniqueRaster raster, double nodata) override;
+        void removeOldest() override;
+        void finalize(Raster *out, double nodata) const override;
+
+        template<class T>
+        void addTyped(TypedRaster<T> *raster, double nodata);
+        template<class T>
+        void removeTyped(TypedRaster<T> *raster, double nodata);
+        template<class T>
+        void finalizeTyped(TypedRaster<T> *out, double nodata) const;
+    private:
+        /**
+         * Resizes the per pixel deques, so that each can hold the values of minCapacity rasters.
+         */
+        void growDeques(uint32_t minCapacity);
+
+        /**
+         * Adds the value to the sum of pixel i, or subtracts it when the raster of the value leaves the window.
+         */
+        void updateSum(int i, A value, bool entering);
+
+        /**
+         * @return The sum of the valid values of pixel i in the window, including the compensation and infinite values.
+         */
+        double getSum(int i) const;
+
+        //Sum and Mean
+        std::vector<A> values;
+        std::vector<uint32_t> counts;
+        //only for floating point sums: the lost low-order part of values and the number of infinite values per pixel.
+        std::vector<A> compensations;
+        std::vector<uint32_t> positiveInfinities;
+        std::vector<uint32_t> negativeInfinities;
+        std::deque<std::pair<UniqueRaster, double>> windowRasters;
+
+        //Min and Max: per pixel ring buffers of capacity entries, with the sequence number of the raster and the value.
+        uint32_t capacity;
+        uint32_t nextSequence;
+        uint32_t oldestSequence;
+        std::vector<uint32_t> dequeSequences;
+        std::vector<A> dequeValues;
+        std::vector<uint32_t> dequeHead;
+        std::vector<uint32_t> dequeLength;
+    };
+
+    /**
+     * Unary raster operation used to call TypedRollingAccumulator::addTyped with the actual type of the input raster.
+     */
+    template<class T>
+    struct RollingAccumulatorAddOperation {
+        template<class A>
+        static void rasterOperation(TypedRaster<T> *raster, TypedRollingAccumulator<A> *accumulator, double nodata) {
+            accumulator->addTyped(raster, nodata);
+        }
+    };
+
+    /**
+     * Unary raster operation used to call TypedRollingAccumulator::removeTyped with the actual type of the leaving raster.
+     */
+    template<class T>
+    struct RollingAccumulatorRemoveOperation {
+        template<class A>
+        static void rasterOperation(TypedRaster<T> *raster, TypedRollingAccumulator<A> *accumulator, double nodata) {
+            accumulator->removeTyped(raster, nodata);
+        }
+    };
+
+    /**
+     * Unary raster operation used to call TypedRollingAccumulator::finalizeTyped with the actual type of the output raster.
+     */
+    template<class T>
+    struct RollingAccumulatorFinalizeOperation {
+        template<class A>
+        static void rasterOperation(TypedRaster<T> *out, const TypedRollingAccumulator<A> *accumulator, double nodata) {
+            accumulator->finalizeTyped(out, nodata);
+        }
+    };
+
+    template<class A>
+    TypedRollingAccumulator<A>::TypedRollingAccumulator(AggregatorFunction function, const Resolution &res)
+            : RollingAccumulator(function, res), capacity(0), nextSequence(0), oldestSequence(0)
+    {
+        if(function == AggregatorFunction::Sum || function == AggregatorFunction::Mean){
+            values.resize(data_length, 0);
+            counts.resize(data_length, 0);
+            if(std::is_floating_point<A>::value){
+                compensations.resize(data_length, 0);
+                positiveInfinities.resize(data_length, 0);
+                negativeInfinities.resize(data_length, 0);
+            }
+        } else {
+            dequeHead.resize(data_length, 0);
+            dequeLength.resize(data_length, 0);
+        }
+    }
+
+    template<class A>
+    void TypedRollingAccumulator<A>::add(UniqueRaster raster, double nodata) {
+        if(raster->getDataLength() != data_length)
+            throw std::runtime_error("RollingAccumulator: added raster does not match the resolution of the accumulator.");
+
+        if(function == AggregatorFunction::Min || function == AggregatorFunction::Max){
+            //a pixel deque contains at most one value per raster of the window.
+            if(windowSize + 1 > capacity)
+                growDeques(std::max(windowSize + 1, capacity * 2));
+        }
+
+        RasterOperations::callUnary<RollingAccumulatorAddOperation>(raster.get(), this, nodata);
+        ++windowSize;
+        ++nextSequence;
+
+        if(function == AggregatorFunction::Sum || function == AggregatorFunction::Mean)
+            windowRasters.emplace_back(std::move(raster), nodata);
+    }
+
+    template<class A>
+    void TypedRollingAccumulator<A>::removeOldest() {
+        if(windowSize == 0)
+            return;
+
+        if(function == AggregatorFunction::Sum || function == AggregatorFunction::Mean){
+            auto &oldest = windowRasters.front();
+            RasterOperations::callUnary<RollingAccumulatorRemoveOperation>(oldest.first.get(), this, oldest.second);
+            windowRasters.pop_front();
+        } else {
+            //only the front of a deque can be the leaving raster, because the sequence numbers in a deque are increasing.
+            for(int i = 0; i < data_length; ++i){
+                if(dequeLength[i] > 0 && dequeSequences[i * capacity + dequeHead[i]] == oldestSequence){
+                    dequeHead[i] = (dequeHead[i] + 1) % capacity;
+                    --dequeLength[i];
+                }
+            }
+        }
+        ++oldestSequence;
+        --windowSize;
+    }
+
+    template<class A>
+    void TypedRollingAccumulator<A>::finalize(Raster *out, double nodata) const {
+        if(out->getDataLength() != data_length)
+            throw std::runtime_error("RollingAccumulator: output raster does not match the resolution of the accumulator.");
+        RasterOperations::callUnary<RollingAccumulatorFinalizeOperation>(out, this, nodata);
+    }
+
+    template<class A>
+    void TypedRollingAccumulator<A>::growDeques(uint32_t minCapacity) {
+        std::vector<uint32_t> newSequences(static_cast<size_t>(data_length) * minCapacity);
+        std::vector<A> newValues(static_cast<size_t>(data_length) * minCapacity);
+        for(int i = 0; i < data_length; ++i){
+            for(uint32_t k = 0; k < dequeLength[i]; ++k){
+                size_t from = static_cast<size_t>(i) * capacity + (dequeHead[i] + k) % capacity;
+                size_t to   = static_cast<size_t>(i) * minCapacity + k;
+                newSequences[to] = dequeSequences[from];
+                newValues[to]    = dequeValues[from];
+            }
+            dequeHead[i] = 0;
+        }
+        dequeSequences = std::move(newSequences);
+        dequeValues = std::move(newValues);
+        capacity = minCapacity;
+    }
+
+    template<class A>
+    void TypedRollingAccumulator<A>::updateSum(int i, A value, bool entering) {
+        if(!std::is_floating_point<A>::value){
+            //integer sums are exact.
+            values[i] += entering ? value : -value;
+            return;
+        }
+        if(!std::isfinite(value)){
+            auto &infinities = value > 0 ? positiveInfinities : negativeInfinities;
+            if(entering)
+                ++infinities[i];
+            else
+                --infinities[i];
+            return;
+        }
+        A y = entering ? value : -value;
+        A sum = values[i] + y;
+        //the low-order part of the smaller operand, that is lost in sum.
+        if(std::abs(values[i]) >= std::abs(y))
+            compensations[i] += (values[i] - sum) + y;
+        else
+            compensations[i] += (y - sum) + values[i];
+        values[i] = sum;
+    }
+
+    template<class A>
+    double TypedRollingAccumulator<A>::getSum(int i) const {
+        if(!std::is_floating_point<A>::value)
+            return static_cast<double>(values[i]);
+        if(positiveInfinities[i] > 0 && negativeInfinities[i] > 0)
+            return std::numeric_limits<double>::quiet_NaN();
+        if(positiveInfinities[i] > 0)
+            return std::numeric_limits<double>::infinity();
+        if(negativeInfinities[i] > 0)
+            return -std::numeric_limits<double>::infinity();
+        return static_cast<double>(values[i] + compensations[i]);
+    }
+
+    template<class A>
+    template<class T>
+    void TypedRollingAccumulator<A>::addTyped(TypedRaster<T> *raster, double nodata) {
+        const T *in = raster->getDataPointer();
+        const T nodataTyped = static_cast<T>(nodata);
+
+        if(function == AggregatorFunction::Sum || function == AggregatorFunction::Mean){
+            for(int i = 0; i < data_length; ++i){
+                if(isValidCell(in[i], nodataTyped)){
+                    updateSum(i, static_cast<A>(in[i]), true);
+                    counts[i] += 1;
+                }
+            }
+            return;
+        }
+
+        const bool isMin = function == AggregatorFunction::Min;
+        for(int i = 0; i < data_length; ++i){
+            if(!isValidCell(in[i], nodataTyped))
+                continue;
+            auto v = static_cast<A>(in[i]);
+            size_t offset = static_cast<size_t>(i) * capacity;
+            uint32_t &head = dequeHead[i];
+            uint32_t &length = dequeLength[i];
+            //values at the back that are not better than the new one can never become the result anymore.
+            while(length > 0){
+                A back = dequeValues[offset + (head + length - 1) % capacity];
+                if(isMin ? back >= v : back <= v)
+                    --length;
+                else
+                    break;
+            }
+            size_t pos = offset + (head + length) % capacity;
+            dequeSequences[pos] = nextSequence;
+            dequeValues[pos] = v;
+            ++length;
+        }
+    }
+
+    template<class A>
+    template<class T>
+    void TypedRollingAccumulator<A>::removeTyped(TypedRaster<T> *raster, double nodata) {
+        const T *in = raster->getDataPointer();
+        const T nodataTyped = static_cast<T>(nodata);
+        for(int i = 0; i < data_length; ++i){
+            if(isValidCell(in[i], nodataTyped)){
+                updateSum(i, static_cast<A>(in[i]), false);
+                counts[i] -= 1;
+            }
+        }
+    }
+
+    template<class A>
+    template<class T>
+    void TypedRollingAccumulator<A>::finalizeTyped(TypedRaster<T> *out, double nodata) const {
+        T *outData = out->getDataPointer();
+        const T nodataTyped = static_cast<T>(nodata);
+
+        switch(function){
+            case AggregatorFunction::Mean:
+                for(int i = 0; i < data_length; ++i){
+                    outData[i] = counts[i] == 0 ? nodataTyped : clampedCast<T>(getSum(i) / counts[i], nodataTyped);
+                }
+                break;
+            case AggregatorFunction::Sum:
+                for(int i = 0; i < data_length; ++i){
+                    outData[i] = counts[i] == 0 ? nodataTyped : clampedCast<T>(getSum(i), nodataTyped);
+                }
+                break;
+            case AggregatorFunction::Min:
+            case AggregatorFunction::Max:
+                for(int i = 0; i < data_length; ++i){
+                    if(dequeLength[i] == 0)
+                        outData[i] = nodataTyped;
+                    else
+                        outData[i] = clampedCast<T>(static_cast<double>(dequeValues[static_cast<size_t>(i) * capacity + dequeHead[i]]), nodataTyped);
+                }
+                break;
+            case AggregatorFunction::Quantile:
+                break;
+        }
+    }
+
+}
+
+#endif //RASTER_TIME_SERIES_ROLLING_ACCUMULATOR_H
@@ -198,6 +198,16 @@ QueryRectangle::QueryRectangle(const Json::Value &qrect)
     else
         throw std::runtime_error("Invalid value for order enum: " + order_str);
     Json::Value tileResJson = qrect["tileRes"];
-    tileRes.resX = tileResJson["x"].asUInt();
-    tileRes.resY = tileResJson["y"].asUInt();
+    if(tileResJson.isString()){
+        if(tileResJson.asString() != "auto")
+            throw std::runtime_error("Invalid value for tileRes: " + tileResJson.asString());
+        tileRes = Resolution(0, 0);
+    } else {
+        tileRes.resX = tileResJson["x"].asUInt();
+        tileRes.resY = tileResJson["y"].asUInt();
+    }
+}
+
+bool QueryRectangle::hasAutoTileRes() const {
+    return tileRes.resX == 0 || tileRes.resY == 0;
 }
@@ -108,8 +108,17 @@ namespace rts {
     public:
         QueryRectangle(double t1, double t2, double x1, double x2, double y1, double y2, uint32_t res_x, uint32_t res_y, Order order, Resolution tileRes);
         QueryRectangle(const TemporalReference &temp_ref, const SpatialReference &spat_ref, const Resolution &res, Order order, Resolution tileRes);
+        /**
+         * Parses the query rectangle. The tileRes can be "auto", then it stays 0x0 until the OperatorTree selects it
+         * from the block layout of the source.
+         */
         explicit QueryRectangle(const Json::Value &qrect);
         QueryRectangle(const QueryRectangle &other) = default;
+
+        /**
+         * @return If the tileRes is "auto" and was not selected yet.
+         */
+        bool hasAutoTileRes() const;
         Order order;
         Resolution tileRes;
     };
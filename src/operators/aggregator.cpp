@@ -2,52 +2,15 @@
 #include <util/raster_calculations.h>
 #include "datatypes/raster_operations.h"
 #include "util/parsing.h"
+#include "util/parallel.h"
 #include "aggregator.h"
 
 using namespace rts;
 using namespace boost::posix_time;
 
-template<class T1, class T2>
-struct AggregatorOperation {
-    static void rasterOperation(TypedRaster<T1> *aggregated_out_raster, TypedRaster<T2> *aggregating_in_raster, int rasterCount, double nodata, AggregatorFunction function){
-        Resolution tileResolution = aggregated_out_raster->getResolution();
-        for(int y = 0; y < tileResolution.resY; ++y){
-            for(int x = 0; x < tileResolution.resX; ++x){
-                T2 val = aggregating_in_raster->getCell(x,y);
-                T1 out_old = aggregated_out_raster->getCell(x,y);
-
-                switch(function){
-                    case AggregatorFunction::Mean:
-                        if(val == (T2)nodata)
-                            aggregated_out_raster->setCell(x, y, (T2)nodata);
-                        else {
-                            T1 curr_avg = aggregated_out_raster->getCell(x, y);
-                            // A is current avg value after I values, than is the avg with the next value x: (A * I + x) / (I+1)
-                            T1 newVal = (curr_avg * (rasterCount) + val) / (rasterCount+1);
-                            aggregated_out_raster->setCell(x,y, newVal);
-                        }
-                        break;
-                    case AggregatorFunction::Min:
-                        if(out_old == (T1)nodata || out_old > val)
-                            aggregated_out_raster->setCell(x, y, (T1)val);
-                        break;
-                    case AggregatorFunction::Max:
-                        if(out_old == (T1)nodata || out_old < val)
-                            aggregated_out_raster->setCell(x, y, (T1)val);
-                        break;
-                    case AggregatorFunction::Sum:
-                        if(val != (T2)nodata){
-                            aggregated_out_raster->setCell(x, y, out_old + (T1)val);
-                        }
-                        break;
-                }
-            }
-        }
-    }
-};
-
 Aggregator::Aggregator(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in)
-        : GenericOperator(operator_tree, qrect, params, std::move(in)), hasTimeInterval(false), lastTileIndex(-1), nextDescriptorAfterSkipping(boost::none)
+        : GenericOperator(operator_tree, qrect, params, std::move(in)), threads(1), temporalMemoryLimit(0), hasTimeInterval(false), lastTileIndex(-1), nextDescriptorAfterSkipping(boost::none),
+          nextOutputIndex(0)
 {
     checkInputCount(1);
 }
@@ -55,6 +18,13 @@ Aggregator::Aggregator(const OperatorTree *operator_tree, const QueryRectangle &
 void Aggregator::initialize() {
     customDataType = params.isMember("custom_data_type") ? Parsing::parseDataType(params["custom_data_type"].asString()) : GDT_Unknown;
     function = Parsing::parseAggregatorFunction(params["function"].asString());
+    accumulatorOptions.quantile = params["function"].asString() == "Median" ? 0.5 : params.get("quantile", 0.5).asDouble();
+    accumulatorOptions.histogramBins = params.get("bins", 256).asUInt();
+    accumulatorOptions.sampleSize = params.get("sample_size", 64).asUInt();
+    if(accumulatorOptions.quantile < 0 || accumulatorOptions.quantile > 1)
+        throw std::runtime_error("Aggregator: quantile must be in [0,1].");
+    threads = Parallel::resolveThreadCount(params.get("threads", 1).asUInt());
+    temporalMemoryLimit = params.get("temporal_memory_limit", 1024 * 1024 * 1024).asUInt64();
 
     hasTimeInterval = params.isMember("time_interval");
     if(hasTimeInterval){
@@ -64,6 +34,9 @@ void Aggregator::initialize() {
 }
 
 OptionalDescriptor Aggregator::nextDescriptor() {
+    if(qrect.order == Order::Temporal)
+        return nextDescriptorTemporal();
+
     //first descriptor could already be loaded in the skip method and stored in nextDescriptorAfterSkipping
     OptionalDescriptor input;
     if(nextDescriptorAfterSkipping) {
@@ -126,6 +99,8 @@ OptionalDescriptor Aggregator::nextDescriptor() {
 }
 
 OptionalDescriptor Aggregator::getDescriptor(int tileIndex) {
+    if(qrect.order == Order::Temporal)
+        return getDescriptorTemporal(tileIndex);
 
     //currTime is the interval start for nextRasterIndex, calc interval start time for rasterIndex from the difference.
     ptime intervalStart = currTime;
@@ -185,6 +160,10 @@ OptionalDescriptor Aggregator::getDescriptor(int tileIndex) {
         descriptors.emplace_back(inDesc);
     }
 
+    //the input has no tile with that index in the interval.
+    if(descriptors.empty())
+        return boost::none;
+
     return createOutput(descriptors, t1, t2);
 }
 
@@ -196,26 +175,133 @@ OptionalDescriptor Aggregator::createOutput(OptionalDescriptorVector &descriptor
     info.rasterInfo.t1 = t1;
     info.rasterInfo.t2 = t2;
 
-    auto getter = [descriptors = std::move(descriptors), function = function](const Descriptor &self) -> UniqueRaster {
-        UniqueRaster out_raster = Raster::createRaster(self.dataType, self.tileResolution);
-        if(function == AggregatorFunction::Min)
-            RasterOperations::callUnary<RasterOperations::AllValuesSetter>(out_raster.get(), self.nodata);
-        else
-            RasterOperations::callUnary<RasterOperations::AllValuesSetter>(out_raster.get(), 0);
-
-        for(int i = 0; i < descriptors.size(); i++){
-            UniqueRaster r = descriptors[i]->getRaster();
-            RasterOperations::callBinary<AggregatorOperation>(out_raster.get(), r.get(), i, self.nodata, function);
+    auto getter = [descriptors = std::move(descriptors), function = function, options = accumulatorOptions, threads = threads](const Descriptor &self) -> UniqueRaster {
+        //accumulate in a wide type and only calculate the result once, instead of updating the output raster per input.
+        //every thread accumulates into its own accumulator, they are merged pairwise afterwards.
+        auto threadCount = static_cast<uint32_t>(std::min<size_t>(threads, descriptors.size()));
+        std::vector<UniqueAccumulator> accumulators(threadCount);
+        for(auto &accumulator : accumulators){
+            accumulator = Accumulator::createAccumulator(function, descriptors[0]->dataType, self.tileResolution, options);
         }
 
+        Parallel::forEach(static_cast<uint32_t>(descriptors.size()), threadCount, [&](uint32_t index, uint32_t threadIndex){
+            UniqueRaster r = descriptors[index]->getRaster();
+            accumulators[threadIndex]->add(r.get(), descriptors[index]->nodata);
+        });
+
+        //tree reduction: in every step the accumulator i merges the accumulator i + step, until all are merged into the first.
+        for(uint32_t step = 1; step < threadCount; step *= 2){
+            uint32_t mergeCount = (threadCount + step - 1) / (2 * step);
+            Parallel::forEach(mergeCount, threadCount, [&](uint32_t index, uint32_t threadIndex){
+                uint32_t target = index * 2 * step;
+                accumulators[target]->merge(*accumulators[target + step]);
+                accumulators[target + step].reset();
+            });
+        }
+
+        UniqueRaster out_raster = Raster::createRaster(self.dataType, self.tileResolution);
+        accumulators[0]->finalize(out_raster.get(), self.nodata);
         return out_raster;
     };
 
     return rts::make_optional<Descriptor>(std::move(getter), info);
 }
 
+OptionalDescriptor Aggregator::nextDescriptorTemporal() {
+    while(nextOutputIndex >= intervalOutputs.size() || !intervalOutputs[nextOutputIndex]){
+        if(nextOutputIndex < intervalOutputs.size()){
+            ++nextOutputIndex; //no input tile for this index in the interval
+            continue;
+        }
+        if(!accumulateNextInterval())
+            return boost::none;
+    }
+    lastTileIndex = static_cast<int>(nextOutputIndex);
+    return intervalOutputs[nextOutputIndex++];
+}
+
+OptionalDescriptor Aggregator::getDescriptorTemporal(int tileIndex) {
+    if(tileIndex < 0 || tileIndex >= intervalOutputs.size())
+        return boost::none;
+    return intervalOutputs[tileIndex];
+}
+
+bool Aggregator::accumulateNextInterval() {
+    intervalOutputs.clear();
+    nextOutputIndex = 0;
+
+    OptionalDescriptor input;
+    if(nextDescriptorAfterSkipping) {
+        input = std::move(nextDescriptorAfterSkipping);
+        nextDescriptorAfterSkipping = boost::none;
+    } else {
+        input = input_operators[0]->nextDescriptor();
+    }
+
+    double aggregateFrom = hasTimeInterval ? static_cast<double>(to_time_t(currTime)) : qrect.t1;
+
+    //rasters before the start of the current interval are not part of any result, the raster is not loaded.
+    while(input && input->rasterInfo.t1 < aggregateFrom){
+        input = input_operators[0]->nextDescriptor();
+    }
+    if(!input)
+        return false;
+
+    //move forward to the interval containing the input, empty intervals do not create output.
+    double aggregateUntil = getNextTimeBorder(false);
+    while(input->rasterInfo.t1 >= aggregateUntil){
+        interval.increase(currTime);
+        aggregateFrom = aggregateUntil;
+        aggregateUntil = getNextTimeBorder(false);
+    }
+
+    //all tiles of the raster have their own accumulator, for quantiles that can be more than the memory of the machine.
+    uint64_t accumulatorBytes = static_cast<uint64_t>(input->rasterTileCount) * input->tileResolution.resX * input->tileResolution.resY
+                                * Accumulator::bytesPerPixel(function, input->dataType, accumulatorOptions);
+    if(accumulatorBytes > temporalMemoryLimit)
+        throw std::runtime_error("Aggregator: the accumulators of all tiles of a raster in temporal order need " + std::to_string(accumulatorBytes)
+                                 + " bytes, more than temporal_memory_limit. Use spatial order or less bins or a smaller sample_size.");
+
+    std::vector<std::shared_ptr<Accumulator>> accumulators(input->rasterTileCount);
+    std::vector<boost::optional<DescriptorInfo>> infos(input->rasterTileCount);
+
+    while(input && input->rasterInfo.t1 < aggregateUntil){
+        auto &accumulator = accumulators[input->tileIndex];
+        if(!accumulator){
+            accumulator = Accumulator::createAccumulator(function, input->dataType, input->tileResolution, accumulatorOptions);
+            infos[input->tileIndex] = DescriptorInfo(input);
+        }
+        UniqueRaster r = input->getRaster();
+        accumulator->add(r.get(), input->nodata);
+        input = input_operators[0]->nextDescriptor();
+    }
+    //the first tile of the next interval.
+    nextDescriptorAfterSkipping = std::move(input);
+    getNextTimeBorder(true);
+
+    intervalOutputs.resize(accumulators.size());
+    for(size_t i = 0; i < accumulators.size(); ++i){
+        if(!accumulators[i])
+            continue;
+        DescriptorInfo info = *infos[i];
+        if(customDataType != GDT_Unknown)
+            info.dataType = customDataType;
+        info.rasterInfo.t1 = aggregateFrom;
+        info.rasterInfo.t2 = aggregateUntil;
+
+        //the rasters are already accumulated, the getter only calculates the result.
+        auto getter = [accumulator = std::shared_ptr<const Accumulator>(std::move(accumulators[i]))](const Descriptor &self) -> UniqueRaster {
+            UniqueRaster out_raster = Raster::createRaster(self.dataType, self.tileResolution);
+            accumulator->finalize(out_raster.get(), self.nodata);
+            return out_raster;
+        };
+        intervalOutputs[i] = rts::make_optional<Descriptor>(std::move(getter), info);
+    }
+    return true;
+}
+
 bool Aggregator::supportsOrder(Order order) const {
-    return order == Order::Spatial;
+    return order == Order::Spatial || order == Order::Temporal;
 }
 
 double Aggregator::getNextTimeBorder(bool increaseCurrTime) {
@@ -234,7 +320,14 @@ double Aggregator::getNextTimeBorder(bool increaseCurrTime) {
 void Aggregator::skipCurrentRaster(const uint32_t skipCount) {
     if(skipCount == 0)
         return;
+    //skipping is based on the calendar intervals in both orders, so empty intervals are counted as skipped as well.
     interval.increase(currTime, skipCount - 1); //-1 because the currTime was already incremented once in nextDescriptor.
+    if(qrect.order == Order::Temporal){
+        //the rasters of the skipped intervals are still read from the input, but they start before currTime,
+        //so accumulateNextInterval does not load them.
+        nextOutputIndex = intervalOutputs.size();
+        return;
+    }
     double aggregateFrom  = static_cast<double>(to_time_t(currTime));
     double aggregateUntil = getNextTimeBorder(false);
     if(aggregateFrom >= qrect.t2){
@@ -253,3 +346,10 @@ void Aggregator::skipCurrentRaster(const uint32_t skipCount) {
     if(inputDesc->rasterInfo.t1 >= aggregateFrom)
         nextDescriptorAfterSkipping = inputDesc;
 }
+
+void Aggregator::skipCurrentTile(const uint32_t skipCount) {
+    if(qrect.order == Order::Temporal)
+        nextOutputIndex += skipCount;
+    else
+        GenericOperator::skipCurrentTile(skipCount);
+}
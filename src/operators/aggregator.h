@@ -3,30 +3,44 @@
 #define RASTER_TIME_SERIES_AGGREGATOR_H
 
 #include "generic_operator.h"
+#include "datatypes/accumulator.h"
 #include "util/gdal_util.h"
 #include "util/time_interval.h"
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 namespace rts {
 
-    enum class AggregatorFunction {
-        Mean,
-        Min,
-        Max,
-        Sum
-    };
-
     /***
      * Allows aggregating in time intervals. If no time interval is provided in the parameters the whole time series is aggregated.
      * The time interval starts from qrect t1 and increases by the passed time interval.
-     * Product is the mean of all rasters of an interval.
+     * The rasters of an interval are accumulated into an Accumulator and the result is calculated once per output tile.
+     * Nodata cells of the input are ignored, output cells without any valid input value are set to nodata.
+     *
+     * In spatial order the rasters of an interval are loaded when the output raster is requested, getDescriptor
+     * re-instantiates the input operators for the requested tile.
+     * In temporal order one Accumulator per tile index is kept for the current interval. The input rasters are accumulated
+     * while reading the input and all tiles of the interval are returned when it is finished, so no re-instantiation is
+     * needed and getDescriptor returns tiles of the last finished interval.
      *
      * Parameters:
      *  - custom_data_type: [Byte, UInt16, Int16, UInt32, Int32, Float32, Float64], when not provided data type of input tiles is used.
-     *  - function: [Mean, Min, Max, Sum]
+     *  - function: [Mean, Min, Max, Sum, Quantile, Median]
+     *  - quantile: the quantile in [0,1] for the Quantile function. Default 0.5, Median is the same as Quantile with 0.5.
+     *  - bins: number of histogram bins per pixel for quantiles of Byte, Int16, and UInt16 inputs. Default 256.
+     *  - sample_size: number of values per pixel kept in a random sample for quantiles of other input types. Default 64.
+     *    Both define the memory/accuracy trade-off of quantiles, see quantile_accumulator.h. With the defaults a
+     *    quantile needs about 1 KiB (bins) or 0.5 KiB (sample) per pixel of an output tile.
+     *  - temporal_memory_limit: only used in temporal order, maximum bytes of the accumulators of all tiles of a raster.
+     *    Default 1 GiB. The aggregation throws when the accumulators would need more, e.g. for the median of a
+     *    3600x1800 raster, use spatial order then, which only keeps the accumulators of one tile.
      *  - time_interval:
      *      - unit: [Year,Month,Day,Hour,Seconds]
-     *      - value: number
+     *      - length: number
+     *  - threads: only used in spatial order, number of threads loading and accumulating the input rasters of an output tile in parallel, 0 for one
+     *             thread per core. Default 1. Every thread accumulates into its own Accumulator, those are merged pairwise
+     *             at the end, so at most one input raster and one Accumulator per thread are in memory at the same time.
+     *             Only use it when the raster getters of the input are independent of each other,
+     *             e.g. not with a cumulative_sum as input.
      *
      */
     class Aggregator : public GenericOperator {
@@ -37,16 +51,33 @@ namespace rts {
         void initialize() override;
         bool supportsOrder(Order order) const override;
         void skipCurrentRaster(uint32_t skipCount) override;
+        void skipCurrentTile(uint32_t skipCount = 1) override;
     private:
         OptionalDescriptor createOutput(OptionalDescriptorVector &list, double t1, double t2);
+        OptionalDescriptor nextDescriptorTemporal();
+        OptionalDescriptor getDescriptorTemporal(int tileIndex);
+
+        /**
+         * Reads the input rasters of the next time interval that contains rasters and accumulates them per tile.
+         * The output descriptors for the interval are stored in intervalOutputs.
+         * @return false when the input has no rasters left.
+         */
+        bool accumulateNextInterval();
         GDALDataType customDataType;
         AggregatorFunction function;
+        AccumulatorOptions accumulatorOptions;
+        uint32_t threads;
+        uint64_t temporalMemoryLimit;
         bool hasTimeInterval;
         TimeInterval interval;
         boost::posix_time::ptime currTime;
         int lastTileIndex;
         OptionalDescriptor nextDescriptorAfterSkipping;
 
+        //state for temporal order
+        OptionalDescriptorVector intervalOutputs;
+        size_t nextOutputIndex;
+
         double getNextTimeBorder(bool increaseCurrTime);
     };
 
@@ -0,0 +1,183 @@
+
+#include <gdal_priv.h>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/filesystem.hpp>
+#include "array_export.h"
+#include "util/tile_codec.h"
+#include "util/parallel.h"
+#include "util/benchmark.h"
+
+using namespace std::string_literals;
+using namespace rts;
+
+ArrayExport::ArrayExport(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, UniqueOperatorVector &&in)
+        : ConsumingOperator(operator_tree, qrect, params, std::move(in)), compress(true), threads(1)
+{
+    checkInputCount(1);
+}
+
+void ArrayExport::initialize() {
+    path            = "results/"s;
+    baseFilename    = params.get("filename", "array").asString();
+    compress        = params.get("compress", true).asBool();
+    threads         = Parallel::resolveThreadCount(params.get("threads", 1).asUInt());
+}
+
+bool ArrayExport::supportsOrder(Order o) const {
+    return o == Order::Temporal || o == Order::Spatial;
+}
+
+void ArrayExport::consume() {
+    boost::filesystem::path p(path.c_str());
+    if(!boost::filesystem::exists(p)){
+        boost::filesystem::create_directory(p);
+    }
+    std::string dataFileName = baseFilename + ".chunks";
+    boost::filesystem::path dataPath = p / dataFileName;
+
+    int file = open(dataPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(file < 0){
+        throw std::runtime_error("Array Export: data file could not be created: " + dataPath.string());
+    }
+
+    std::map<std::pair<double, int>, Chunk> chunks;
+    std::map<double, double> times;
+    boost::optional<DescriptorInfo> first;
+    std::atomic<uint64_t> fileSize(0);
+    std::vector<std::vector<uint8_t>> buffers(threads);
+    GenericOperator *in_op = input_operators[0].get();
+
+    //the descriptors are created one after another, their tiles are loaded, encoded and written in parallel.
+    const size_t batchSize = 4 * threads;
+    std::vector<OptionalDescriptor> batch;
+    std::vector<Chunk> written;
+    bool inputLeft = true;
+    try {
+        while(inputLeft){
+            batch.clear();
+            while(batch.size() < batchSize){
+                auto desc = in_op->nextDescriptor();
+                if(!desc){
+                    inputLeft = false;
+                    break;
+                }
+                batch.push_back(std::move(desc));
+            }
+            written.assign(batch.size(), Chunk{0, 0});
+
+            Parallel::forEach(static_cast<uint32_t>(batch.size()), threads, [&](uint32_t index, uint32_t threadIndex){
+                UniqueRaster raster = batch[index]->getRaster();
+                Benchmark::startConsuming();
+                const uint8_t *data = nullptr;
+                size_t size = 0;
+                if(compress){
+                    TileCodec::encode(raster.get(), buffers[threadIndex]);
+                    data = buffers[threadIndex].data();
+                    size = buffers[threadIndex].size();
+                } else {
+                    data = static_cast<const uint8_t*>(raster->getVoidDataPointer());
+                    size = static_cast<size_t>(raster->getDataLength()) * raster->sizeOfDataType();
+                }
+
+                //reserving the range lets all threads write at the same time.
+                uint64_t offset = fileSize.fetch_add(size);
+                size_t done = 0;
+                while(done < size){
+                    ssize_t count = pwrite(file, data + done, size - done, static_cast<off_t>(offset + done));
+                    if(count <= 0)
+                        throw std::runtime_error("Array Export: writing into data file failed.");
+                    done += static_cast<size_t>(count);
+                }
+                written[index] = Chunk{offset, size};
+                Benchmark::endConsuming();
+            });
+
+            for(size_t i = 0; i < batch.size(); ++i){
+                const Descriptor &desc = *batch[i];
+                if(!first)
+                    first = DescriptorInfo(batch[i]);
+                times[desc.rasterInfo.t1] = desc.rasterInfo.t2;
+                chunks[std::make_pair(desc.rasterInfo.t1, static_cast<int>(desc.tileIndex))] = written[i];
+            }
+        }
+    } catch(...) {
+        close(file);
+        throw;
+    }
+
+    if(close(file) != 0){
+        throw std::runtime_error("Array Export: writing into data file failed.");
+    }
+    if(first){
+        Benchmark::startConsuming();
+        writeIndex(chunks, times, *first, dataFileName);
+        Benchmark::endConsuming();
+    }
+}
+
+void ArrayExport::writeIndex(const std::map<std::pair<double, int>, Chunk> &chunks, const std::map<double, double> &times, const DescriptorInfo &first, const std::string &dataFileName) const {
+    const Resolution &tileRes = first.tileResolution;
+    const Resolution &tileCount = first.rasterTileCountDimensional;
+
+    //the chunk grid is the tile grid, the first tile can start outside of the query.
+    auto column = static_cast<long>(first.tileIndex % tileCount.resX);
+    auto row = static_cast<long>(first.tileIndex / tileCount.resX);
+    long chunkStartX = std::lround((first.tileSpatialInfo.x1 - first.rasterInfo.x1) / first.rasterInfo.scale.x) - column * static_cast<long>(tileRes.resX);
+    long chunkStartY = std::lround((first.tileSpatialInfo.y1 - first.rasterInfo.y1) / first.rasterInfo.scale.y) - row * static_cast<long>(tileRes.resY);
+
+    Json::Value index;
+    index["data_file"] = dataFileName;
+    index["encoding"] = compress ? "tile_codec" : "raw";
+    index["data_type"] = GDALGetDataTypeName(first.dataType);
+    index["nodata"] = first.nodata;
+    index["shape"]["time"] = static_cast<Json::UInt>(times.size());
+    index["shape"]["y"] = first.rasterInfo.resY;
+    index["shape"]["x"] = first.rasterInfo.resX;
+    index["chunk_shape"]["time"] = 1;
+    index["chunk_shape"]["y"] = tileRes.resY;
+    index["chunk_shape"]["x"] = tileRes.resX;
+    index["chunk_count"]["time"] = static_cast<Json::UInt>(times.size());
+    index["chunk_count"]["y"] = tileCount.resY;
+    index["chunk_count"]["x"] = tileCount.resX;
+    index["chunk_start"]["y"] = static_cast<Json::Int64>(chunkStartY);
+    index["chunk_start"]["x"] = static_cast<Json::Int64>(chunkStartX);
+    index["extent"]["x1"] = first.rasterInfo.x1;
+    index["extent"]["y1"] = first.rasterInfo.y1;
+    index["extent"]["x2"] = first.rasterInfo.x2;
+    index["extent"]["y2"] = first.rasterInfo.y2;
+    index["projection"] = first.rasterInfo.projection.authority + ":" + std::to_string(first.rasterInfo.projection.code);
+
+    //chunks are listed by time, tile row and tile column, missing chunks are null.
+    index["times"] = Json::Value(Json::arrayValue);
+    index["chunks"] = Json::Value(Json::arrayValue);
+    for(auto &time : times){
+        Json::Value t(Json::arrayValue);
+        t.append(time.first);
+        t.append(time.second);
+        index["times"].append(t);
+        for(int tile = 0; tile < static_cast<int>(tileCount.resX * tileCount.resY); ++tile){
+            auto it = chunks.find(std::make_pair(time.first, tile));
+            if(it == chunks.end()){
+                index["chunks"].append(Json::Value());
+                continue;
+            }
+            Json::Value chunk(Json::arrayValue);
+            chunk.append(static_cast<Json::UInt64>(it->second.offset));
+            chunk.append(static_cast<Json::UInt64>(it->second.size));
+            index["chunks"].append(chunk);
+        }
+    }
+
+    boost::filesystem::path indexPath = boost::filesystem::path(path) / (baseFilename + ".json");
+    std::ofstream file(indexPath.string(), std::ios::trunc);
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "\t";
+    file << Json::writeString(writer, index);
+    if(!file){
+        throw std::runtime_error("Array Export: index file could not be written: " + indexPath.string());
+    }
+}
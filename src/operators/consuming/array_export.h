@@ -0,0 +1,57 @@
+
+
+#ifndef RASTER_TIME_SERIES_ARRAY_EXPORT_H
+#define RASTER_TIME_SERIES_ARRAY_EXPORT_H
+
+#include <map>
+#include "operators/consuming/consuming_operator.h"
+
+namespace rts {
+
+    /**
+     * Operator for exporting a raster time series into a single chunked array store, instead of a GeoTiff file per raster.
+     * The array has the dimensions time x y x x and every chunk is one tile of one raster. The chunks are encoded with
+     * the TileCodec and appended to the data file <filename>.chunks in the order they are finished. The index file
+     * <filename>.json describes the array: data type, nodata, shape, chunk shape, the times of the rasters and the
+     * position and size of every chunk in the data file, ordered by time, tile row and tile column.
+     * The chunks of the first tile row and column can start left of and above the query rectangle, chunk_start is the
+     * pixel position of the first chunk in the array. Pixels of the chunks outside of the query are nodata.
+     *
+     * The tiles can arrive in any order. They are loaded, encoded and written by multiple threads, a batch of tiles
+     * at a time, so the input operators must allow calling the getters of several descriptors at once.
+     * Both files are written to the results directory.
+     *
+     * Params:
+     *  - filename: base name of the data and index file. Default "array".
+     *  - compress: when false the chunks are stored uncompressed. Default true.
+     *  - threads: number of threads loading and writing tiles, 0 for one per core. Default 1.
+     */
+    class ArrayExport : public ConsumingOperator {
+    public:
+        explicit ArrayExport(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in);
+        void consume() override;
+        void initialize() override;
+        bool supportsOrder(Order o) const override;
+    private:
+        /**
+         * Position of a chunk in the data file.
+         */
+        struct Chunk {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        /**
+         * Writes the index file for the chunks, keyed by the start time of their raster and their tile index.
+         */
+        void writeIndex(const std::map<std::pair<double, int>, Chunk> &chunks, const std::map<double, double> &times, const DescriptorInfo &first, const std::string &dataFileName) const;
+
+        std::string path;
+        std::string baseFilename;
+        bool compress;
+        uint32_t threads;
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_ARRAY_EXPORT_H
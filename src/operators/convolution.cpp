@@ -158,6 +158,19 @@ OptionalDescriptor Convolution::getDescriptor(int tileIndex) {
     return createOutput(mainDescriptor, tileIndex);
 }
 
+OptionalDescriptorVector Convolution::getDescriptors(const std::vector<int> &tileIndices) {
+    auto mainDescriptors = input_operators[0]->getDescriptors(tileIndices);
+    OptionalDescriptorVector result;
+    result.reserve(tileIndices.size());
+    for(size_t i = 0; i < tileIndices.size(); ++i){
+        if(mainDescriptors[i])
+            result.emplace_back(createOutput(mainDescriptors[i], tileIndices[i]));
+        else
+            result.emplace_back(boost::none);
+    }
+    return result;
+}
+
 OptionalDescriptor Convolution::createOutput(OptionalDescriptor &mainDescriptor, uint32_t mainTileIndex) {
 
     OptionalDescriptorVector neighbours;
@@ -194,8 +207,13 @@ OptionalDescriptor Convolution::createOutput(OptionalDescriptor &mainDescriptor,
     return rts::make_optional<Descriptor>(std::move(getter), info);
 }
 
+bool Convolution::pushDownSampling(uint32_t toReturn, uint32_t toSkip) {
+    //every output raster only depends on the input raster with the same time, so skipping input rasters skips outputs.
+    return input_operators[0]->pushDownSampling(toReturn, toSkip);
+}
+
 bool Convolution::supportsOrder(Order order) const {
-    return order == Order::Temporal;
+    return order == Order::Temporal || order == Order::Spatial;
 }
 
 bool Convolution::isInRange(int x, int y, Resolution tileCountDimensional) const {
@@ -215,6 +233,12 @@ void Convolution::fillWithNeighbourTiles(OptionalDescriptorVector &neighbours, i
     int indexX = tileIndex % tileCountDimensional.resX;
     int indexY = tileIndex / tileCountDimensional.resX;
 
+    //collect the indices of the neighbours inside of the raster first, to request them all at once.
+    std::vector<int> neighbourIndices;
+    std::vector<int> neighbourDirections;
+    neighbourIndices.reserve(8);
+    neighbourDirections.reserve(8);
+
     for(int i = 1; i < 9; i++){
         auto dir = static_cast<DirectionEight>(i);
         int x = indexX;
@@ -251,14 +275,21 @@ void Convolution::fillWithNeighbourTiles(OptionalDescriptorVector &neighbours, i
                 break;
         }
 
-        //if (x,y) is in range at its tile into neighbours, else add a nullopt.
+        //if (x,y) is in range request its tile, else the neighbour stays a nullopt.
         if(isInRange(x, y, tileCountDimensional)){
-            int index = x + y * tileCountDimensional.resX;
-            neighbours.push_back(input_operators[0]->getDescriptor(index));
-        } else {
-            neighbours.emplace_back(boost::none);
-
+            neighbourIndices.push_back(x + y * tileCountDimensional.resX);
+            neighbourDirections.push_back(i);
         }
     }
 
+    neighbours.resize(9);
+    auto loaded = input_operators[0]->getDescriptors(neighbourIndices);
+    for(size_t i = 0; i < loaded.size(); ++i){
+        //in spatial order the input must still be at the timestamp of the center tile, a neighbour of another
+        //timestamp would silently give wrong pixels at the edges of the tile.
+        if(loaded[i] && loaded[i]->rasterInfo.t1 != neighbours[0]->rasterInfo.t1)
+            throw std::runtime_error("Convolution: the input returned a neighbour tile of another timestamp than the center tile.");
+        neighbours[neighbourDirections[i]] = std::move(loaded[i]);
+    }
+
 }
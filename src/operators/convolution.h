@@ -12,14 +12,21 @@ namespace rts {
      * Support for different convolution function kernels must be added in the future.
      *
      * The important problem this operator solves is, how to handle accessing multiple adjacent tiles to output one tile.
-     * So this operator caches all tile descriptors of a raster into a vector when opening the first tile.
-     * Which tile of the currently cached raster is worked on, is determined by the member currTileIndex.
+     * The neighbouring tiles are loaded by random access through getDescriptor() of the input operator. Random access
+     * always returns the tile of the raster the input operator currently is at. Therefore this works for both orders:
+     * In temporal order the neighbours are tiles of the raster that is currently iterated. In spatial order the input
+     * stays at the timestamp of the last returned tile, so the neighbours are the tiles of the same timestamp in
+     * the adjacent tile positions. That way no order changer is needed in front of a spatially ordered convolution.
+     * The neighbours of a tile are requested with a single getDescriptors() call. A neighbour with another timestamp
+     * than the tile is an error of the query and throws a std::runtime_error.
      */
     class Convolution : public GenericOperator {
     public:
         Convolution(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, UniqueOperatorVector &&in);
         OptionalDescriptor nextDescriptor() override;
         OptionalDescriptor getDescriptor(int tileIndex);
+        OptionalDescriptorVector getDescriptors(const std::vector<int> &tileIndices) override;
+        bool pushDownSampling(uint32_t toReturn, uint32_t toSkip) override;
         void initialize() override;
         bool supportsOrder(Order order) const override;
     private:
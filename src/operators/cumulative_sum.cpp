@@ -19,16 +19,24 @@ struct CumSumAdder {
 };
 
 CumulativeSum::CumulativeSum(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in)
-        : GenericOperator(operator_tree, qrect, params, std::move(in)), sum(nullptr), lastTileIndex(-1), lastTileT2(0)
+        : GenericOperator(operator_tree, qrect, params, std::move(in)), sum(nullptr), lastTileIndex(-1), lastTileT2(0),
+          checkpointInterval(0), rastersOfTile(0)
 {
     checkInputCount(1);
 }
 
 void CumulativeSum::initialize() {
-
+    checkpointInterval = params.get("checkpoint_interval", 0).asUInt();
+    checkpoints = std::make_unique<TileStore>(params.get("checkpoint_memory_limit", 256u * 1024 * 1024).asUInt64(),
+                                              params.get("checkpoint_directory", "").asString());
+    if(params.isMember("running_sum_directory"))
+        runningSums = std::make_unique<TileStore>(0, params["running_sum_directory"].asString());
 }
 
 OptionalDescriptor CumulativeSum::nextDescriptor() {
+    if(qrect.order == Order::Temporal)
+        return nextDescriptorTemporal();
+
     auto input = input_operators[0]->nextDescriptor();
 
     if(!input)
@@ -42,7 +50,10 @@ OptionalDescriptor CumulativeSum::nextDescriptor() {
     if(sum->getDataLength() == 0 || lastTileIndex != input->tileIndex) {
         setSumRasterZero(input->tileResolution);
         firstTileTemp = input->rasterInfo;
+        rastersOfTile = 0;
     }
+    ++rastersOfTile;
+    bool isCheckpoint = checkpointInterval > 0 && rastersOfTile % checkpointInterval == 0;
 
     lastTileIndex = input->tileIndex;
     DescriptorInfo descInfo(input);
@@ -50,9 +61,61 @@ OptionalDescriptor CumulativeSum::nextDescriptor() {
     //this is to keep the cumulated tiles distinguishable.
     lastTileT2 = descInfo.rasterInfo.t2;
 
-    auto getter = [input = std::move(input), sum = sum.get()](const Descriptor &self) -> UniqueRaster {
+    auto getter = [input = std::move(input), sum = sum.get(), checkpoints = checkpoints.get(), isCheckpoint](const Descriptor &self) -> UniqueRaster {
+        UniqueRaster raster_in = input->getRaster();
+        RasterOperations::callBinary<CumSumAdder>(sum, raster_in.get(), self.tileResolution);
+        if(isCheckpoint)
+            checkpoints->put(self.tileIndex, self.rasterInfo.t1, sum);
+        return raster_in;
+    };
+
+    return rts::make_optional<Descriptor>(std::move(getter), descInfo);
+}
+
+OptionalDescriptor CumulativeSum::nextDescriptorTemporal() {
+    auto input = input_operators[0]->nextDescriptor();
+
+    if(!input)
+        return boost::none;
+
+    auto tileIndex = static_cast<size_t>(input->tileIndex);
+    if(tileIndex >= tileRasterCounts.size()){
+        tileRasterCounts.resize(tileIndex + 1, 0);
+        tileSums.resize(tileIndex + 1);
+    }
+    ++tileRasterCounts[tileIndex];
+    bool isCheckpoint = checkpointInterval > 0 && tileRasterCounts[tileIndex] % checkpointInterval == 0;
+
+    //the running sums on disk are loaded in the getter, the ones in memory are created here.
+    Raster *tileSum = nullptr;
+    if(runningSums == nullptr){
+        if(tileSums[tileIndex] == nullptr){
+            tileSums[tileIndex] = Raster::createRaster(input->dataType, input->tileResolution);
+            RasterOperations::callUnary<RasterOperations::AllValuesSetter>(tileSums[tileIndex].get(), 0);
+        }
+        tileSum = tileSums[tileIndex].get();
+    }
+
+    DescriptorInfo descInfo(input);
+    lastTileT2 = descInfo.rasterInfo.t2;
+
+    auto getter = [input = std::move(input), tileSum, runningSums = runningSums.get(), checkpoints = checkpoints.get(), isCheckpoint](const Descriptor &self) -> UniqueRaster {
         UniqueRaster raster_in = input->getRaster();
+        UniqueRaster loadedSum;
+        Raster *sum = tileSum;
+        if(sum == nullptr){
+            loadedSum = runningSums->get(self.tileIndex, 0);
+            if(loadedSum == nullptr){
+                loadedSum = Raster::createRaster(self.dataType, self.tileResolution);
+                RasterOperations::callUnary<RasterOperations::AllValuesSetter>(loadedSum.get(), 0);
+            }
+            sum = loadedSum.get();
+        }
         RasterOperations::callBinary<CumSumAdder>(sum, raster_in.get(), self.tileResolution);
+        if(loadedSum != nullptr)
+            runningSums->put(self.tileIndex, 0, sum);
+        if(isCheckpoint)
+            checkpoints->put(self.tileIndex, self.rasterInfo.t1, sum);
         return raster_in;
     };
 
@@ -60,7 +123,7 @@ OptionalDescriptor CumulativeSum::nextDescriptor() {
 }
 
 bool CumulativeSum::supportsOrder(Order order) const {
-    return order == Order::Spatial;
+    return order == Order::Spatial || order == Order::Temporal;
 }
 
 void CumulativeSum::setSumRasterZero(const Resolution &res) {
@@ -73,10 +136,18 @@ OptionalDescriptor CumulativeSum::getDescriptor(int tileIndex) {
     double t1 = qrect.t1;
     double t2 = lastTileT2;
 
+    //start from the latest checkpoint, the rasters until the checkpoint do not have to be loaded.
+    double checkpointTime = 0;
+    bool hasCheckpoint = checkpointInterval > 0 && checkpoints->findLatestBefore(tileIndex, t2, checkpointTime);
+    if(hasCheckpoint)
+        t1 = checkpointTime;
+
     std::vector<OptionalDescriptor> descriptors;
 
     Resolution tileRes = qrect.tileRes;
-    Resolution tileCount;
+    Resolution tileCount = RasterCalculations::calculateTileCount(qrect, qrect.projection.getOrigin(), qrect.scale).first;
+    if(tileIndex < 0 || tileIndex >= tileCount.resX * tileCount.resY)
+        return boost::none;
 
     auto cloneQrect = qrect;
     cloneQrect.t1 = t1;
@@ -103,9 +174,8 @@ OptionalDescriptor CumulativeSum::getDescriptor(int tileIndex) {
     auto clonedOperator = input_operators[0]->reInstantiate(cloneQrect);
 
     for(auto &inDesc : *clonedOperator){
-        //it can be that the first raster still overlaps with t1,t2 but started before t1
-        // and must therefore be part of the previous output raster.
-        if(inDesc.rasterInfo.t1 < t1 || inDesc.rasterInfo.t1 >= t2)
+        //like in nextDescriptor the first raster is part of the sum when it started before t1 but still overlaps it.
+        if(inDesc.rasterInfo.t2 <= t1 || inDesc.rasterInfo.t1 >= t2)
             continue;
 
         inDesc.rasterInfo.x1 = qrect.x1;
@@ -115,10 +185,8 @@ OptionalDescriptor CumulativeSum::getDescriptor(int tileIndex) {
         inDesc.rasterInfo.resX = qrect.resX;
         inDesc.rasterInfo.resY = qrect.resY;
         inDesc.tileIndex = tileIndex;
-
-        //TODO: set these:
-        //inDesc.rasterTileCount;
-        //inDesc.rasterTileCountDimensional;
+        inDesc.rasterTileCount = tileCount.resX * tileCount.resY;
+        inDesc.rasterTileCountDimensional = tileCount;
 
         descriptors.emplace_back(inDesc);
     }
@@ -126,18 +194,34 @@ OptionalDescriptor CumulativeSum::getDescriptor(int tileIndex) {
     if(descriptors.empty())
         return boost::none;
 
-    DescriptorInfo descInfo(qrect, spatInfo, tileRes, Order::Spatial, tileIndex, tileCount, descriptors[0]->nodata, descriptors[0]->dataType);
+    DescriptorInfo descInfo(qrect, spatInfo, tileRes, qrect.order, tileIndex, tileCount, descriptors[0]->nodata, descriptors[0]->dataType);
 
     //set temp. info to last raster.
     descInfo.rasterInfo.t1 = descriptors[descriptors.size() - 1]->rasterInfo.t1;
     descInfo.rasterInfo.t2 = descriptors[descriptors.size() - 1]->rasterInfo.t2;
 
-    auto getter = [descriptors = std::move(descriptors)](const Descriptor &self) -> UniqueRaster {
-        auto sum = Raster::createRaster(self.dataType, self.tileResolution);
-        RasterOperations::callUnary<RasterOperations::AllValuesSetter>(sum.get(), 0);
+    auto getter = [descriptors = std::move(descriptors), checkpoints = checkpoints.get(), checkpointInterval = checkpointInterval,
+                   hasCheckpoint, checkpointTime](const Descriptor &self) -> UniqueRaster {
+        UniqueRaster sum;
+        if(hasCheckpoint){
+            sum = checkpoints->get(self.tileIndex, checkpointTime);
+            if(sum == nullptr)
+                throw std::runtime_error("CumulativeSum: checkpoint tile not found.");
+        } else {
+            sum = Raster::createRaster(self.dataType, self.tileResolution);
+            RasterOperations::callUnary<RasterOperations::AllValuesSetter>(sum.get(), 0);
+        }
+        uint32_t addedRasters = 0;
         for(auto &desc : descriptors){
+            //the raster of the checkpoint is already part of the sum.
+            if(hasCheckpoint && desc->rasterInfo.t1 <= checkpointTime)
+                continue;
             UniqueRaster raster_in = desc->getRaster();
             RasterOperations::callBinary<CumSumAdder>(sum.get(), raster_in.get(), self.tileResolution);
+            //checkpoints stay at the same distance, because summing up started at the query start or a checkpoint.
+            ++addedRasters;
+            if(checkpointInterval > 0 && addedRasters % checkpointInterval == 0)
+                checkpoints->put(self.tileIndex, desc->rasterInfo.t1, sum.get());
         }
         return sum;
     };
@@ -3,9 +3,29 @@
 #define RASTER_TIME_SERIES_CUMULATIVE_SUM_H
 
 #include "operators/generic_operator.h"
+#include "util/tile_store.h"
 
 namespace rts {
 
+    /**
+     * Cumulative sum over the rasters of the time series, the output for a raster is the sum of all previous rasters of
+     * the query and itself.
+     * While summing up, the sum of every checkpoint_interval-th raster of a tile is stored as checkpoint. Random access
+     * with getDescriptor starts from the latest checkpoint of the tile, so it loads at most checkpoint_interval rasters
+     * instead of all rasters since the start of the query. Checkpoints are off by default, they only pay off when the
+     * operator is accessed with getDescriptor. The checkpoints are kept in memory up to checkpoint_memory_limit bytes,
+     * further checkpoints are spilled to disk.
+     *
+     * Supports spatial and temporal order. In spatial order a single sum raster is reset when the next tile starts.
+     * In temporal order every tile index has its own running sum, that is kept in memory or, for rasters with
+     * many tiles, written to disk into running_sum_directory.
+     *
+     * Parameters:
+     *  - checkpoint_interval: number of rasters between two checkpoints, 0 disables checkpoints. Default 0.
+     *  - checkpoint_memory_limit: bytes of checkpoints kept in memory before spilling to disk. Default 256 MiB.
+     *  - checkpoint_directory: directory the checkpoints are spilled to. Default is the temp directory of the system.
+     *  - running_sum_directory: when provided, the running sums of temporal order are written to disk into this directory.
+     */
     class CumulativeSum : public GenericOperator {
     public:
         CumulativeSum(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in);
@@ -14,10 +34,18 @@ namespace rts {
         void initialize() override;
         bool supportsOrder(Order order) const override;
     private:
+        OptionalDescriptor nextDescriptorTemporal();
+
         UniqueRaster sum;
         int lastTileIndex;
         TemporalReference firstTileTemp;
         double lastTileT2;
+        uint32_t checkpointInterval;
+        uint32_t rastersOfTile;
+        std::unique_ptr<TileStore> checkpoints;
+        std::vector<UniqueRaster> tileSums;
+        std::vector<uint32_t> tileRasterCounts;
+        std::unique_ptr<TileStore> runningSums;
         void setSumRasterZero(const Resolution &res);
     };
 
@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include "datatypes/raster_operations.h"
 #include "operators/expression_operator.h"
 
@@ -54,6 +55,48 @@ OptionalDescriptor ExpressionOperator::getDescriptor(int tileIndex) {
     return rts::make_optional<Descriptor>(std::move(getter), descInfo);
 }
 
+OptionalDescriptorVector ExpressionOperator::getDescriptors(const std::vector<int> &tileIndices) {
+
+    std::vector<OptionalDescriptorVector> inputTiles;
+    inputTiles.reserve(input_operators.size());
+    for(auto &input_op : input_operators){
+        inputTiles.emplace_back(input_op->getDescriptors(tileIndices));
+    }
+
+    OptionalDescriptorVector result;
+    result.reserve(tileIndices.size());
+    for(size_t tile = 0; tile < tileIndices.size(); ++tile){
+        std::vector<OptionalDescriptor> inputs;
+        inputs.reserve(input_operators.size());
+        for(auto &tiles : inputTiles){
+            inputs.emplace_back(std::move(tiles[tile]));
+        }
+        bool allValid = std::all_of(inputs.begin(), inputs.end(), [](const OptionalDescriptor &in){ return static_cast<bool>(in); });
+        if(!allValid){
+            result.emplace_back(boost::none);
+            continue;
+        }
+
+        DescriptorInfo descInfo(inputs[0]);
+        auto getter = expression.createGetter(std::move(inputs));
+        result.emplace_back(rts::make_optional<Descriptor>(std::move(getter), descInfo));
+    }
+    return result;
+}
+
+bool ExpressionOperator::pushDownSampling(uint32_t toReturn, uint32_t toSkip) {
+    //all inputs have to sample the same way, else the sampling is removed from the inputs that accepted it.
+    for(size_t i = 0; i < input_operators.size(); ++i){
+        if(!input_operators[i]->pushDownSampling(toReturn, toSkip)){
+            for(size_t j = 0; j < i; ++j){
+                input_operators[j]->pushDownSampling(0, 0);
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
 bool ExpressionOperator::supportsOrder(Order order) const {
     return order == Order::Temporal || order == Order::Spatial;
 }
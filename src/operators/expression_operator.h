@@ -18,6 +18,8 @@ namespace rts {
         ExpressionOperator(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in);
         OptionalDescriptor nextDescriptor() override;
         OptionalDescriptor getDescriptor(int tileIndex) override;
+        OptionalDescriptorVector getDescriptors(const std::vector<int> &tileIndices) override;
+        bool pushDownSampling(uint32_t toReturn, uint32_t toSkip) override;
         void initialize() override;
         bool supportsOrder(Order order) const override;
     private:
@@ -43,6 +43,19 @@ void GenericOperator::callInitializeRecursively(GenericOperator *op){
     }
 }
 
+OptionalDescriptorVector GenericOperator::getDescriptors(const std::vector<int> &tileIndices) {
+    OptionalDescriptorVector result;
+    result.reserve(tileIndices.size());
+    for(int tileIndex : tileIndices){
+        result.emplace_back(getDescriptor(tileIndex));
+    }
+    return result;
+}
+
+bool GenericOperator::pushDownSampling(uint32_t toReturn, uint32_t toSkip) {
+    return false;
+}
+
 void GenericOperator::skipCurrentRaster(const uint32_t skipCount) {
     for(auto &input_op : input_operators){
         input_op->skipCurrentRaster(skipCount);
@@ -35,6 +35,15 @@ namespace rts {
          */
         virtual OptionalDescriptor getDescriptor(int tileIndex) = 0;
 
+        /**
+         * Random access to several tiles of the current raster at once. The default calls getDescriptor() for every
+         * index, operators that can share work between the tiles, e.g. sources opening the dataset only once and
+         * reading adjacent tiles together, override it.
+         * @param tileIndices The indices of the tiles to return.
+         * @return One descriptor per index, in the same order as the indices.
+         */
+        virtual OptionalDescriptorVector getDescriptors(const std::vector<int> &tileIndices);
+
         /**
          *
          * @param order
@@ -42,6 +51,14 @@ namespace rts {
          */
         virtual bool supportsOrder(Order order) const = 0;
 
+        /**
+         * Asks the operator to take over the sampling of a Sampler above it: return toReturn rasters, then skip
+         * toSkip rasters, repeatedly. An operator that can do this without creating the skipped rasters returns true,
+         * then the Sampler only passes through the tiles. The default does not support it and returns false.
+         * Must be called before the operator is initialized. toReturn = 0 removes the sampling again.
+         */
+        virtual bool pushDownSampling(uint32_t toReturn, uint32_t toSkip);
+
         TimeSeriesIterator begin();
         TimeSeriesIterator end();
 
@@ -1,14 +1,27 @@
 
+#include <fstream>
+#include <cstring>
+#include <numeric>
+#include <boost/filesystem.hpp>
 #include "operators/order_changer.h"
 
 using namespace rts;
 
 OrderChanger::OrderChanger(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in)
-        : GenericOperator(operator_tree, qrect, params, std::move(in)), initialized(false), temporalTargetDescriptor(boost::none)
+        : GenericOperator(operator_tree, qrect, params, std::move(in)), initialized(false), temporalTargetDescriptor(boost::none),
+          tilesPerRaster(0), rasterCount(0), lastRaster(0), spillChunkSize(0), chunkRasters(0), tileBytes(0)
 {
     checkInputCount(1);
 }
 
+OrderChanger::~OrderChanger() {
+    spillFile.reset();
+    if(!spillPath.empty()){
+        boost::system::error_code ec;
+        boost::filesystem::remove(spillPath, ec);
+    }
+}
+
 void OrderChanger::initialize() {
     //The qrect contains the order this operator should produce the tiles in.
     //So change the incoming order to the opposite and set it recursively for
@@ -17,7 +30,10 @@ void OrderChanger::initialize() {
     incomingOrder = targetOrder == Order::Temporal ? Order::Spatial : Order::Temporal;
     setOrderOfChildOperators(this, incomingOrder);
     currRaster = 0;
-    currTile = -1;
+    //the temporal target increases the tile before returning it, the spatial target after it.
+    currTile = targetOrder == Order::Temporal ? -1 : 0;
+    spillDirectory = params.get("spill_directory", "").asString();
+    spillChunkSize = params.get("spill_chunk_size", 64 * 1024 * 1024).asUInt64();
 }
 
 OptionalDescriptor OrderChanger::nextDescriptor() {
@@ -40,14 +56,24 @@ OptionalDescriptor OrderChanger::nextDescriptor() {
             temporalTargetDescriptor = input_operators[0]->nextDescriptor();
             if(!temporalTargetDescriptor || temporalTargetDescriptor->tileIndex > 0)
                 return boost::none;
+            //request the other tiles of the raster at once.
+            std::vector<int> tileIndices(temporalTargetDescriptor->rasterTileCount - 1);
+            std::iota(tileIndices.begin(), tileIndices.end(), 1);
+            temporalTargetTiles = input_operators[0]->getDescriptors(tileIndices);
         }
 
-        auto desc = (currTile == 0) ? temporalTargetDescriptor : input_operators[0]->getDescriptor(currTile);
+        auto desc = (currTile == 0) ? temporalTargetDescriptor : std::move(temporalTargetTiles[currTile - 1]);
+        if(!desc)
+            return boost::none;
 
         desc->order = targetOrder;
 
         return desc;
 
+    } else if(!spillDirectory.empty()) {
+
+        return nextSpilledDescriptor();
+
     } else {
 
         //Temporal to Spatial is not changed, still load into cache
@@ -75,6 +101,7 @@ OptionalDescriptor OrderChanger::nextDescriptor() {
 
         uint64_t index = currTile + currRaster * tilesPerRaster;
 
+        lastRaster = currRaster;
         currRaster += 1;
         if(currRaster == rasterCount){
             currRaster = 0;
@@ -103,7 +130,129 @@ OptionalDescriptor OrderChanger::getDescriptor(int tileIndex) {
     if(targetOrder == Order::Temporal){
         return input_operators[0]->getDescriptor(tileIndex);
     } else {
-        uint64_t index = tileIndex + currRaster * tilesPerRaster;
+        if(tileIndex < 0 || tileIndex >= tilesPerRaster)
+            return boost::none;
+        if(!spillDirectory.empty())
+            return createSpilledDescriptor(lastRaster, static_cast<uint32_t>(tileIndex));
+        uint64_t index = tileIndex + lastRaster * tilesPerRaster;
         return descriptors[index];
     }
 }
+
+OptionalDescriptorVector OrderChanger::getDescriptors(const std::vector<int> &tileIndices) {
+    if(targetOrder == Order::Temporal)
+        return input_operators[0]->getDescriptors(tileIndices);
+    return GenericOperator::getDescriptors(tileIndices);
+}
+
+OptionalDescriptor OrderChanger::nextSpilledDescriptor() {
+    if(!initialized){
+        spillInput();
+        initialized = true;
+    }
+
+    if(rasterCount == 0 || currTile >= tilesPerRaster)
+        return boost::none;
+
+    //prepare reading the contiguous range of the tile in the next chunk.
+    if(currRaster % chunkRasters == 0){
+        uint32_t rastersInChunk = std::min<uint64_t>(chunkRasters, rasterCount - currRaster);
+        spillFile->adviseSequential(spillOffset(currRaster, currTile), rastersInChunk * tileBytes);
+    }
+
+    auto desc = createSpilledDescriptor(currRaster, currTile);
+
+    lastRaster = currRaster;
+    currRaster += 1;
+    if(currRaster == rasterCount){
+        currRaster = 0;
+        currTile += 1;
+    }
+    return desc;
+}
+
+OptionalDescriptor OrderChanger::createSpilledDescriptor(uint32_t rasterIndex, uint32_t tileIndex) const {
+    const DescriptorInfo &info = spilledInfos[static_cast<size_t>(rasterIndex) * tilesPerRaster + tileIndex];
+
+    auto getter = [file = spillFile, offset = spillOffset(rasterIndex, tileIndex), size = tileBytes](const Descriptor &self) -> UniqueRaster {
+        UniqueRaster raster = Raster::createRaster(self.dataType, self.tileResolution);
+        std::memcpy(raster->getVoidDataPointer(), file->getData() + offset, size);
+        return raster;
+    };
+
+    return rts::make_optional<Descriptor>(std::move(getter), info);
+}
+
+size_t OrderChanger::spillOffset(uint32_t rasterIndex, uint32_t tileIndex) const {
+    //all chunks before the chunk of the raster are complete, only the last chunk can contain less rasters.
+    uint32_t chunk = rasterIndex / chunkRasters;
+    uint64_t chunkStart = static_cast<uint64_t>(chunk) * chunkRasters;
+    uint64_t rastersInChunk = std::min<uint64_t>(chunkRasters, rasterCount - chunkStart);
+    size_t chunkOffset = chunkStart * tilesPerRaster * tileBytes;
+    return chunkOffset + (tileIndex * rastersInChunk + (rasterIndex - chunkStart)) * tileBytes;
+}
+
+void OrderChanger::spillInput() {
+    boost::filesystem::path p(spillDirectory);
+    if(!boost::filesystem::exists(p))
+        boost::filesystem::create_directories(p);
+    p /= boost::filesystem::unique_path("rts_order_changer_%%%%-%%%%-%%%%.spill");
+    spillPath = p.string();
+    std::ofstream file(spillPath, std::ios::binary | std::ios::trunc);
+    if(!file)
+        throw std::runtime_error("Order Changer: could not create spill file " + spillPath);
+
+    //the chunk buffer stores the rasters of a chunk with a stride of chunkRasters per tile index.
+    std::vector<char> chunk;
+    uint32_t rastersInChunk = 0;
+    auto writeChunk = [&](){
+        if(rastersInChunk == chunkRasters){
+            file.write(chunk.data(), chunk.size());
+        } else {
+            for(uint32_t tile = 0; tile < tilesPerRaster; ++tile)
+                file.write(chunk.data() + static_cast<size_t>(tile) * chunkRasters * tileBytes, rastersInChunk * tileBytes);
+        }
+        rastersInChunk = 0;
+    };
+
+    uint64_t tilesRead = 0;
+    for(auto desc : *input_operators[0]){
+        if(tilesRead == 0){
+            tilesPerRaster = desc.rasterTileCount;
+            tileBytes = static_cast<size_t>(desc.tileResolution.resX) * desc.tileResolution.resY * GDALGetDataTypeSizeBytes(desc.dataType);
+            size_t rasterBytes = tilesPerRaster * tileBytes;
+            chunkRasters = static_cast<uint32_t>(std::max<size_t>(1, spillChunkSize / rasterBytes));
+            chunk.resize(chunkRasters * rasterBytes);
+        }
+        if(desc.tileIndex >= tilesPerRaster)
+            throw std::runtime_error("Order Changer: tile index exceeds the tiles per raster count.");
+
+        UniqueRaster raster = desc.getRaster();
+        if(static_cast<size_t>(raster->getDataLength()) * raster->sizeOfDataType() != tileBytes)
+            throw std::runtime_error("Order Changer: all tiles must have the same size for spilling.");
+        size_t position = (static_cast<size_t>(desc.tileIndex) * chunkRasters + rastersInChunk) * tileBytes;
+        std::memcpy(chunk.data() + position, raster->getVoidDataPointer(), tileBytes);
+
+        desc.order = targetOrder;
+        spilledInfos.emplace_back(static_cast<const DescriptorInfo&>(desc));
+
+        ++tilesRead;
+        if(tilesRead % tilesPerRaster == 0){
+            ++rastersInChunk;
+            if(rastersInChunk == chunkRasters)
+                writeChunk();
+        }
+    }
+
+    if(tilesRead % tilesPerRaster != 0)
+        throw std::runtime_error("Order Changer: number of tiles does not match a multiple of the tiles per raster count.");
+    if(rastersInChunk > 0)
+        writeChunk();
+    file.close();
+    if(!file)
+        throw std::runtime_error("Order Changer: could not write spill file " + spillPath);
+
+    rasterCount = tilesPerRaster == 0 ? 0 : tilesRead / tilesPerRaster;
+    totalTiles = tilesRead;
+    spillFile = std::make_shared<MappedFile>(spillPath);
+}
@@ -2,19 +2,48 @@
 #ifndef RASTER_TIME_SERIES_ORDER_CHANGER_H
 #define RASTER_TIME_SERIES_ORDER_CHANGER_H
 
+#include <memory>
 #include "generic_operator.h"
+#include "util/mapped_file.h"
 
 namespace rts {
 
+    /**
+     * Changes the order of the tiles from spatial to temporal or the other way around. The qrect order is the target
+     * order, the input operators are set to the opposite order.
+     * Spatial to temporal uses random tile access on the input. After the first tile of a raster, the other tiles of it
+     * are requested with a single getDescriptors call, so sources can load them together.
+     * Temporal to spatial has to read the whole input first. By default the input descriptors are kept in memory and their
+     * getters are called when the tiles are returned in spatial order.
+     * With spill_directory the tiles are loaded in temporal order instead and written to a spill file, then the
+     * descriptors are only metadata reading the tiles from the memory mapped file. The file is written in chunks of
+     * rasters, inside of a chunk all tiles with the same tile index are stored next to each other. So the memory is
+     * bounded by the chunk size, and reading a tile index in spatial order reads one contiguous range per chunk.
+     *
+     * Parameters:
+     *  - spill_directory: when provided, temporal to spatial uses a spill file in this directory.
+     *  - spill_chunk_size: size of a chunk of the spill file in bytes. Default 64 MiB, at least one raster per chunk.
+     */
     class OrderChanger : public GenericOperator {
     public:
         OrderChanger(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in);
         OptionalDescriptor nextDescriptor() override;
         OptionalDescriptor getDescriptor(int tileIndex) override;
+        OptionalDescriptorVector getDescriptors(const std::vector<int> &tileIndices) override;
         void initialize() override;
         bool supportsOrder(Order order) const override;
+        ~OrderChanger() override;
     private:
+        /**
+         * Loads all tiles of the input in temporal order and writes them to the spill file.
+         */
+        void spillInput();
+        OptionalDescriptor nextSpilledDescriptor();
+        OptionalDescriptor createSpilledDescriptor(uint32_t rasterIndex, uint32_t tileIndex) const;
+        size_t spillOffset(uint32_t rasterIndex, uint32_t tileIndex) const;
+
         OptionalDescriptor temporalTargetDescriptor;
+        OptionalDescriptorVector temporalTargetTiles;
         std::vector<OptionalDescriptor> descriptors;
         uint32_t tilesPerRaster;
         uint64_t rasterCount;
@@ -24,6 +53,14 @@ namespace rts {
         Order targetOrder;
         Order incomingOrder;
         bool initialized;
+        uint32_t lastRaster;
+        std::string spillDirectory;
+        size_t spillChunkSize;
+        std::string spillPath;
+        std::shared_ptr<MappedFile> spillFile;
+        std::vector<DescriptorInfo> spilledInfos;
+        uint32_t chunkRasters;
+        size_t tileBytes;
         /**
          * Recursively sets the the qrect.order of all input operators of op to order. Does not change the order of op.
          */
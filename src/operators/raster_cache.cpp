@@ -1,20 +1,38 @@
 
+#include <iostream>
 #include "operators/raster_cache.h"
 
 
 rts::RasterCache::RasterCache(const rts::OperatorTree *operator_tree, const rts::QueryRectangle &qrect,
                                     const Json::Value &params, rts::UniqueOperatorVector &&in)
-                                    : GenericOperator(operator_tree, qrect, params, std::move(in)), lastTileIndex(0)
+                                    : GenericOperator(operator_tree, qrect, params, std::move(in)), printStatistics(false)
 {
     checkInputCount(1);
 }
 
-void rts::RasterCache::initialize() {
+rts::RasterCache::~RasterCache() {
+    if(printStatistics){
+        std::cout << "RasterCache: " << cache->getHits() << " hits, " << cache->getMisses() << " misses, "
+                  << cache->getEvictions() << " evictions, " << cache->getByteSize() << " bytes cached";
+        if(cache->isCompressed())
+            std::cout << " (" << cache->getDecodedByteSize() << " bytes decoded)";
+        std::cout << ".\n";
+    }
+}
 
+void rts::RasterCache::initialize() {
+    //only the instance creating the cache prints the statistics, not the re-instantiated ones.
+    bool createsCache = !operator_tree->hasTileCache();
+    cache = operator_tree->getTileCache(params.get("cache_size", 256 * 1024 * 1024).asUInt64(), params.get("compress", false).asBool());
+    printStatistics = createsCache && params.get("print_statistics", false).asBool();
 }
 
 bool rts::RasterCache::supportsOrder(rts::Order order) const {
-    return order == Order::Temporal;
+    return order == Order::Temporal || order == Order::Spatial;
+}
+
+const rts::TileCache& rts::RasterCache::getCache() const {
+    return *cache;
 }
 
 rts::OptionalDescriptor rts::RasterCache::nextDescriptor() {
@@ -23,15 +41,6 @@ rts::OptionalDescriptor rts::RasterCache::nextDescriptor() {
     if(!input)
         return boost::none;
 
-    if(input->tileIndex == 0){ //new raster
-        cache.clear();
-        if(cache.capacity() < input->rasterTileCount)
-            cache.reserve(input->rasterTileCount);
-        for(int i = 0; i < input->rasterTileCount; ++i){
-            cache.emplace_back(nullptr);
-        }
-    }
-
     return createOutput(input);
 }
 
@@ -42,19 +51,28 @@ rts::OptionalDescriptor rts::RasterCache::getDescriptor(int tileIndex) {
     return createOutput(input);
 }
 
-rts::OptionalDescriptor rts::RasterCache::createOutput(OptionalDescriptor &input) {
-    lastTileIndex = input->tileIndex;
+rts::OptionalDescriptorVector rts::RasterCache::getDescriptors(const std::vector<int> &tileIndices) {
+    auto inputs = input_operators[0]->getDescriptors(tileIndices);
+    for(auto &input : inputs){
+        if(input)
+            input = createOutput(input);
+    }
+    return inputs;
+}
 
+rts::OptionalDescriptor rts::RasterCache::createOutput(OptionalDescriptor &input) {
     DescriptorInfo info(input);
 
-    auto getter = [input = std::move(input), &cache = cache](const Descriptor &self) -> UniqueRaster {
-        if(cache[self.tileIndex] == nullptr){
-            cache[self.tileIndex] = input->getRaster();
+    auto getter = [input = std::move(input), cache = cache](const Descriptor &self) -> UniqueRaster {
+        TileCacheKey key{self.rasterInfo.t1, self.tileSpatialInfo.x1, self.tileSpatialInfo.y1, self.dataType,
+                         self.tileResolution.resX, self.tileResolution.resY};
+        UniqueRaster raster = cache->get(key);
+        if(raster == nullptr){
+            raster = input->getRaster();
+            cache->put(key, raster.get());
         }
-        auto res = cache[self.tileIndex]->getResolution();
-        return Raster::createRaster(self.dataType, res.resX, res.resY, cache[self.tileIndex]->getVoidDataPointer());
+        return raster;
     };
 
-
     return rts::make_optional<Descriptor>(std::move(getter), info);
 }
@@ -1,30 +1,47 @@
-
 #ifndef RASTER_TIME_SERIES_CACHE_SIMULATOR_H
 #define RASTER_TIME_SERIES_CACHE_SIMULATOR_H
 
 #include "operators/generic_operator.h"
+#include "util/tile_cache.h"
 
 namespace rts {
 
     /**
-     * Operator that caches the tile data of a raster but not for tiles from multiple different rasters.
+     * Operator that caches the tile data of its input in a TileCache with a budget in bytes, evicting the least
+     * recently used tiles. Tiles of any number of rasters are cached, identified by the start time of their raster,
+     * their position, data type and resolution, so it works in both orders and for random access with getDescriptor.
      * It does not change incoming descriptors, except it is changing the getRaster closure.
-     * The closure checks if the tile is already present in an internal list and if so it loads it from there.
-     * If it is not available the tile data will be loaded and saved in the list.
+     * The closure checks if the tile is already in the cache and if so it copies it from there.
+     * If it is not available the tile data will be loaded and saved in the cache.
      * Can be used, for example, before convolution operator to stop loading the same tile data multiple times from disk.
-     * It will cache the tile data only for the time of executing the query.
+     * The cache is shared by all instances of the operator in a query, so instances that are re-instantiated by
+     * aggregator or cumulative sum for random access use it, too. It will cache the tile data only for the time of
+     * executing the query.
+     *
+     * Parameters:
+     *  - cache_size: budget of the cache in bytes. Default 256 MiB.
+     *  - compress: when true, the tiles are stored encoded with the TileCodec, so more tiles fit into the budget,
+     *    and are decoded on every hit. Default false.
+     *  - print_statistics: when true, the hits, misses and evictions of the cache are printed when the query ends.
      */
     class RasterCache : public GenericOperator {
     public:
         RasterCache(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, UniqueOperatorVector &&in);
+        ~RasterCache() override;
         OptionalDescriptor nextDescriptor() override;
-        OptionalDescriptor getDescriptor(int tileIndex);
+        OptionalDescriptor getDescriptor(int tileIndex) override;
+        OptionalDescriptorVector getDescriptors(const std::vector<int> &tileIndices) override;
         void initialize() override;
         bool supportsOrder(Order order) const override;
+
+        /**
+         * @return The cache shared by all instances of this operator, e.g. to read its hit and miss counters.
+         */
+        const TileCache& getCache() const;
     private:
         OptionalDescriptor createOutput(OptionalDescriptor &input);
-        std::vector<UniqueRaster> cache;
-        int lastTileIndex;
+        std::shared_ptr<TileCache> cache;
+        bool printStatistics;
     };
 
 }
@@ -0,0 +1,139 @@
+
+#include <cstring>
+#include "util/parsing.h"
+#include "operators/rolling_aggregator.h"
+
+using namespace rts;
+using namespace boost::posix_time;
+
+RollingAggregator::RollingAggregator(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in)
+        : GenericOperator(operator_tree, qrect, params, std::move(in)), windowSize(0), hasTimeInterval(false),
+          currentRasterTime(0), inputAfterSkipping(boost::none)
+{
+    checkInputCount(1);
+}
+
+void RollingAggregator::initialize() {
+    customDataType = params.isMember("custom_data_type") ? Parsing::parseDataType(params["custom_data_type"].asString()) : GDT_Unknown;
+    function = Parsing::parseAggregatorFunction(params["function"].asString());
+
+    hasTimeInterval = params.isMember("time_interval");
+    if(hasTimeInterval){
+        //with a length of 0 the window would not even contain the current raster.
+        const Json::Value &length = params["time_interval"]["length"];
+        if(!length.isNumeric() || length.asDouble() <= 0)
+            throw std::runtime_error("RollingAggregator: the length of the time_interval has to be greater than 0.");
+        interval = TimeInterval(params["time_interval"]);
+    } else {
+        windowSize = params.get("window_size", 0).asUInt();
+        if(windowSize == 0)
+            throw std::runtime_error("RollingAggregator: either window_size or time_interval has to be provided.");
+    }
+}
+
+bool RollingAggregator::supportsOrder(Order order) const {
+    return order == Order::Temporal;
+}
+
+OptionalDescriptor RollingAggregator::nextDescriptor() {
+    OptionalDescriptor input = readInput();
+    if(!input)
+        return boost::none;
+    currentRasterTime = input->rasterInfo.t1;
+    return processTile(input);
+}
+
+OptionalDescriptor RollingAggregator::getDescriptor(int tileIndex) {
+    //the input tile is added to the window of its tile index, when nextDescriptor reaches it the stored output is returned.
+    OptionalDescriptor input = input_operators[0]->getDescriptor(tileIndex);
+    if(!input)
+        return boost::none;
+    return processTile(input);
+}
+
+OptionalDescriptor RollingAggregator::readInput() {
+    if(inputAfterSkipping){
+        OptionalDescriptor input = std::move(inputAfterSkipping);
+        inputAfterSkipping = boost::none;
+        return input;
+    }
+    return input_operators[0]->nextDescriptor();
+}
+
+OptionalDescriptor RollingAggregator::processTile(OptionalDescriptor &input) {
+    if(tileWindows.size() < input->rasterTileCount)
+        tileWindows.resize(input->rasterTileCount);
+
+    TileWindow &window = tileWindows[input->tileIndex];
+    double t1 = input->rasterInfo.t1;
+    if(window.output && !window.rasterTimes.empty() && window.rasterTimes.back() == t1)
+        return window.output;
+
+    if(!window.accumulator)
+        window.accumulator = RollingAccumulator::createRollingAccumulator(function, input->dataType, input->tileResolution);
+
+    window.accumulator->add(input->getRaster(), input->nodata);
+    window.rasterTimes.push_back(t1);
+
+    if(hasTimeInterval){
+        ptime windowStartTime = from_time_t(static_cast<time_t>(t1));
+        interval.decrease(windowStartTime);
+        auto windowStart = static_cast<double>(to_time_t(windowStartTime));
+        while(!window.rasterTimes.empty() && window.rasterTimes.front() <= windowStart){
+            window.rasterTimes.pop_front();
+            window.accumulator->removeOldest();
+        }
+    } else {
+        while(window.rasterTimes.size() > windowSize){
+            window.rasterTimes.pop_front();
+            window.accumulator->removeOldest();
+        }
+    }
+
+    DescriptorInfo info(input);
+    if(customDataType != GDT_Unknown)
+        info.dataType = customDataType;
+
+    //the window moves on with the next raster, so the result is calculated now and copied for every getRaster call.
+    std::shared_ptr<Raster> result = Raster::createRaster(info.dataType, info.tileResolution);
+    window.accumulator->finalize(result.get(), info.nodata);
+
+    auto getter = [result = std::move(result)](const Descriptor &self) -> UniqueRaster {
+        UniqueRaster out = Raster::createRaster(self.dataType, self.tileResolution);
+        std::memcpy(out->getVoidDataPointer(), result->getVoidDataPointer(), static_cast<size_t>(result->getDataLength()) * result->sizeOfDataType());
+        return out;
+    };
+
+    window.output = rts::make_optional<Descriptor>(std::move(getter), info);
+    return window.output;
+}
+
+void RollingAggregator::skipCurrentRaster(const uint32_t skipCount) {
+    if(skipCount == 0)
+        return;
+
+    uint32_t rastersLeft = skipCount;
+    while(true){
+        OptionalDescriptor input = readInput();
+        if(!input)
+            return;
+        if(input->rasterInfo.t1 != currentRasterTime){
+            currentRasterTime = input->rasterInfo.t1;
+            if(--rastersLeft == 0){
+                inputAfterSkipping = std::move(input);
+                return;
+            }
+        }
+        processTile(input);
+    }
+}
+
+void RollingAggregator::skipCurrentTile(const uint32_t skipCount) {
+    for(uint32_t i = 0; i < skipCount; ++i){
+        OptionalDescriptor input = readInput();
+        if(!input)
+            return;
+        currentRasterTime = input->rasterInfo.t1;
+        processTile(input);
+    }
+}
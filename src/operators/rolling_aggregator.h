@@ -0,0 +1,76 @@
+
+#ifndef RASTER_TIME_SERIES_ROLLING_AGGREGATOR_H
+#define RASTER_TIME_SERIES_ROLLING_AGGREGATOR_H
+
+#include <deque>
+#include "operators/generic_operator.h"
+#include "datatypes/rolling_accumulator.h"
+#include "util/time_interval.h"
+
+namespace rts {
+
+    /**
+     * Moving window aggregation over the time series. For every input raster one output raster is returned that aggregates
+     * the window of rasters ending with that input raster, it keeps the temporal validity of the input raster.
+     * The window is either a fixed number of rasters or a time interval. In the latter case the window contains the
+     * rasters starting within the time interval before and including the start of the current raster.
+     * Every tile index has a RollingAccumulator that is updated incrementally: the entering raster is added and
+     * the rasters leaving the window are removed, so the work per raster does not depend on the window length.
+     * Nodata cells of the input are ignored, output cells without any valid input value in the window are set to nodata.
+     *
+     * Only supports temporal order, because the windows of all tiles of a raster are advanced together.
+     * The input rasters are loaded and accumulated when the descriptor is created. Skipped rasters and tiles are still
+     * accumulated, otherwise the windows of the following rasters would miss them.
+     *
+     * Parameters:
+     *  - function: [Mean, Min, Max, Sum]
+     *  - custom_data_type: [Byte, UInt16, Int16, UInt32, Int32, Float32, Float64], when not provided data type of input tiles is used.
+     *  - window_size: number of rasters in the window, including the current raster.
+     *  - time_interval: alternative to window_size.
+     *      - unit: [Year,Month,Day,Hour,Seconds]
+     *      - length: number greater than 0
+     *
+     */
+    class RollingAggregator : public GenericOperator {
+    public:
+        RollingAggregator(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in);
+        OptionalDescriptor nextDescriptor() override;
+        OptionalDescriptor getDescriptor(int tileIndex) override;
+        void initialize() override;
+        bool supportsOrder(Order order) const override;
+        void skipCurrentRaster(uint32_t skipCount = 1) override;
+        void skipCurrentTile(uint32_t skipCount = 1) override;
+    private:
+        /**
+         * The window state of a single tile index.
+         */
+        struct TileWindow {
+            UniqueRollingAccumulator accumulator;
+            std::deque<double> rasterTimes;
+            OptionalDescriptor output;
+        };
+
+        /**
+         * Returns the next input descriptor, also the one that was read ahead while skipping.
+         */
+        OptionalDescriptor readInput();
+
+        /**
+         * Moves the window of the input tile forward to the input raster and creates the output descriptor.
+         * When the window of the tile was already moved to the raster of the input, the stored output is returned.
+         */
+        OptionalDescriptor processTile(OptionalDescriptor &input);
+
+        GDALDataType customDataType;
+        AggregatorFunction function;
+        uint32_t windowSize;
+        bool hasTimeInterval;
+        TimeInterval interval;
+        std::vector<TileWindow> tileWindows;
+        double currentRasterTime;
+        OptionalDescriptor inputAfterSkipping;
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_ROLLING_AGGREGATOR_H
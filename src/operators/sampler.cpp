@@ -5,17 +5,21 @@ using namespace rts;
 
 Sampler::Sampler(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in)
         : GenericOperator(operator_tree, qrect, params, std::move(in)),
-          toSkip(params["to_skip"].asUInt()), toReturn(params["to_return"].asUInt()), returningCount(0)
+          toSkip(params["to_skip"].asUInt()), toReturn(params["to_return"].asUInt()), returningCount(0), samplingPushedDown(false)
 {
     checkInputCount(1);
 }
 
 void Sampler::initialize() {
-
+    //when the input can skip the rasters itself, they are never created and this operator only passes the tiles through.
+    samplingPushedDown = toReturn > 0 && input_operators[0]->pushDownSampling(toReturn, toSkip);
 }
 
 OptionalDescriptor Sampler::nextDescriptor() {
 
+    if(samplingPushedDown)
+        return input_operators[0]->nextDescriptor();
+
     //if returningCount is bigger that toReturn: this is the last tile to return before skipping.
     if(returningCount >= toReturn){
 
@@ -51,6 +55,10 @@ OptionalDescriptor Sampler::getDescriptor(int tileIndex) {
     return input_operators[0]->getDescriptor(tileIndex);
 }
 
+OptionalDescriptorVector Sampler::getDescriptors(const std::vector<int> &tileIndices) {
+    return input_operators[0]->getDescriptors(tileIndices);
+}
+
 bool Sampler::supportsOrder(Order order) const {
     return order == Order::Temporal || order == Order::Spatial;
 }
@@ -14,6 +14,9 @@ namespace rts {
      * The operator is not sampling at the moment, because it is not known, how many rasters a time series has.
      * Therefore it just skipping rasters at the moment.
      *
+     * When the input supports it, the skipping is pushed down with pushDownSampling(), e.g. into the source operator,
+     * which then jumps over the skipped rasters without opening them.
+     *
      * Parameters:
      *  - to_skip: how many rasters must be skipped at once. [uint]
      *  - to_keep: how many rasters will be returned after a skip. [uint]
@@ -23,6 +26,7 @@ namespace rts {
         Sampler(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in);
         OptionalDescriptor nextDescriptor() override;
         OptionalDescriptor getDescriptor(int tileIndex) override;
+        OptionalDescriptorVector getDescriptors(const std::vector<int> &tileIndices) override;
         void initialize() override;
         bool supportsOrder(Order order) const override;
     private:
@@ -30,6 +34,7 @@ namespace rts {
         const uint32_t toReturn;
         uint32_t returningCount;
         uint32_t lastSendTileIndex;
+        bool samplingPushedDown;
     };
 
 }
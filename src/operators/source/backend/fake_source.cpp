@@ -1,28 +1,93 @@
 
-#include <fstream>
-#include <iostream>
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <functional>
-#include <boost/filesystem.hpp>
 #include "datatypes/raster_operations.h"
+#include "datatypes/accumulator.h"
 #include "datatypes/descriptor.h"
 #include "util/raster_calculations.h"
 #include "util/parsing.h"
+#include "util/dataset_catalog.h"
 #include "fake_source.h"
 
 using namespace rts;
 
+namespace {
+
+    //salts, so noise, nodata holes and constant tiles of the same pixel are independent.
+    constexpr uint64_t HOLE_SALT = 0x68d3a1b5c0e9f247ULL;
+    constexpr uint64_t TILE_SALT = 0x2f7c95e1a4b8d063ULL;
+
+    uint64_t mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    /**
+     * @return Value in [0, 1) that only depends on the parameters.
+     */
+    double hashUnit(uint64_t seed, int64_t rasterIndex, int64_t worldX, int64_t worldY) {
+        uint64_t h = mix(seed ^ mix(static_cast<uint64_t>(rasterIndex) ^ mix(static_cast<uint64_t>(worldX) ^ mix(static_cast<uint64_t>(worldY)))));
+        return static_cast<double>(h >> 11) / 9007199254740992.0;
+    }
+
+}
+
 template<class T>
 struct FakeSourceWriter {
-    static void rasterOperation(TypedRaster<T> *raster, Resolution fill_from, Resolution res_left_to_fill, int index, double nodata, bool fillIndex){
+    static void rasterOperation(TypedRaster<T> *raster, Resolution fillFrom, Resolution resLeftToFill, int pixelStartX, int pixelStartY,
+                                int64_t worldX, int64_t worldY, int index, double nodata, const FakeSource::PatternInfo *p)
+    {
         Resolution res = raster->getResolution();
-        for (int x = 0; x < res.resX; ++x) {
-            for (int y = 0; y < res.resY; ++y) {
-                int val = fillIndex ? index : x + y;
-                if(x >= fill_from.resX && y >= fill_from.resY && x < res_left_to_fill.resX && y < res_left_to_fill.resY)
-                    raster->setCell(x, y, (T)val);
-                else
-                    raster->setCell(x, y, (T)nodata);
+        const int width = res.resX;
+        const int height = res.resY;
+        const int x1 = std::min<int>(fillFrom.resX, width);
+        const int y1 = std::min<int>(fillFrom.resY, height);
+        const int x2 = std::max(x1, std::min<int>(resLeftToFill.resX, width));
+        const int y2 = std::max(y1, std::min<int>(resLeftToFill.resY, height));
+        const T nodataValue = static_cast<T>(nodata);
+        const double range = p->valueMax - p->valueMin;
+
+        bool constantTile = p->constantTiles > 0 && hashUnit(p->seed ^ TILE_SALT, index, worldX, worldY) < p->constantTiles;
+        //the value range can exceed the data type, the values are clamped to it.
+        T constantValue = clampedCast<T>(p->pattern == FakePattern::RasterIndex ? index : p->valueMin, nodataValue);
+        if(constantTile)
+            constantValue = clampedCast<T>(p->valueMin + range * hashUnit(p->seed, index, worldX, worldY), nodataValue);
+
+        T *data = raster->getDataPointer();
+        for (int y = 0; y < height; ++y) {
+            T *row = data + static_cast<size_t>(y) * width;
+            if(y < y1 || y >= y2){
+                std::fill(row, row + width, nodataValue);
+                continue;
+            }
+            std::fill(row, row + x1, nodataValue);
+            std::fill(row + x2, row + width, nodataValue);
+
+            if(constantTile || p->pattern == FakePattern::RasterIndex || p->pattern == FakePattern::Constant){
+                std::fill(row + x1, row + x2, constantValue);
+                if(constantTile)
+                    continue;
+            } else if(p->pattern == FakePattern::PixelSum){
+                for (int x = x1; x < x2; ++x)
+                    row[x] = clampedCast<T>(x + y, nodataValue);
+            } else if(p->pattern == FakePattern::Gradient){
+                double start = p->valueMin + p->gradientStep * (pixelStartX + pixelStartY + y + index);
+                for (int x = x1; x < x2; ++x)
+                    row[x] = clampedCast<T>(start + p->gradientStep * x, nodataValue);
+            } else {
+                for (int x = x1; x < x2; ++x)
+                    row[x] = clampedCast<T>(p->valueMin + range * hashUnit(p->seed, index, worldX + x, worldY + y), nodataValue);
+            }
+
+            if(p->nodataHoles > 0){
+                for (int x = x1; x < x2; ++x) {
+                    if(hashUnit(p->seed ^ HOLE_SALT, index, worldX + x, worldY + y) < p->nodataHoles)
+                        row[x] = nodataValue;
+                }
             }
         }
     }
@@ -30,31 +95,58 @@ struct FakeSourceWriter {
 
 FakeSource::FakeSource(const QueryRectangle &qrect, const Json::Value &params) : SourceBackend(qrect, params)
 {
-    lastTime = -1;
-    currRasterIndex = 0;
+
 }
 
 void FakeSource::initialize() {
-    auto dataset_json = loadDatasetJson(params["dataset"].asString());
+    auto dataset = DatasetCatalog::getFakeSourceDataset(params["dataset"].asString());
+    const Json::Value &dataset_json = dataset->json;
     rasterCount = dataset_json["raster_count"].asInt();
     datasetStartTime = dataset_json["time_start"].asDouble();
-    datasetEndTime = std::numeric_limits<double>::max();
     timeDuration = dataset_json["time_duration"].asDouble();
+    datasetEndTime = datasetStartTime + (rasterCount - 1) * timeDuration;
 
     nodata = dataset_json["nodata"].asDouble();
     dataType = Parsing::parseDataType(dataset_json["data_type"].asString());
+    origin = qrect.projection.getOrigin();
+
+    //the params of the operator override the pattern of the dataset.
+    auto setting = [&](const char *name, const Json::Value &defaultValue) -> Json::Value {
+        if(params.isMember(name))
+            return params[name];
+        return dataset_json.get(name, defaultValue);
+    };
+
+    auto info = std::make_shared<PatternInfo>();
+    info->pattern = parsePattern(setting("pattern", "pixel_sum").asString());
+    if(params.get("fill_with_index", false).asBool())
+        info->pattern = FakePattern::RasterIndex;
+    info->seed = setting("seed", 0).asUInt64();
+    info->valueMin = setting("value_min", 0).asDouble();
+    info->valueMax = setting("value_max", 100).asDouble();
+    info->nodataHoles = setting("nodata_holes", 0).asDouble();
+    info->constantTiles = setting("constant_tiles", 0).asDouble();
+    info->gradientStep = (info->valueMax - info->valueMin) / (static_cast<double>(qrect.resX) + qrect.resY + std::max(rasterCount, 1));
+    pattern = std::move(info);
+}
 
-    extent = qrect.projection.getExtent();
-    fill_with_index = params.get("fill_with_index", false).asBool();
+FakePattern FakeSource::parsePattern(const std::string &input) {
+    if(input == "pixel_sum")
+        return FakePattern::PixelSum;
+    else if(input == "raster_index")
+        return FakePattern::RasterIndex;
+    else if(input == "gradient")
+        return FakePattern::Gradient;
+    else if(input == "noise")
+        return FakePattern::Noise;
+    else if(input == "constant")
+        return FakePattern::Constant;
+    else
+        throw std::runtime_error("Fake Source: unknown pattern " + input);
 }
 
-Json::Value FakeSource::loadDatasetJson(std::string name) {
-    boost::filesystem::path p("../../test/data/fake_source");
-    p /= name + ".json";
-    std::ifstream file_in(p.string());
-    Json::Value dataset_json;
-    file_in >> dataset_json;
-    return dataset_json;
+int FakeSource::rasterIndex(double time) const {
+    return static_cast<int>(std::lround((time - datasetStartTime) / timeDuration));
 }
 
 OptionalDescriptor FakeSource::createDescriptor(double time, int pixelStartX, int pixelStartY, int tileIndex, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin, const Resolution &tileCount) {
@@ -71,16 +163,13 @@ OptionalDescriptor FakeSource::createDescriptor(double time, int pixelStartX, in
     Resolution res_left_to_fill(qrect.resX - pixelStartX, qrect.resY - pixelStartY);
 
     Resolution tile_start_world_res(rasterWorldPixelStart.resX + pixelStartX, rasterWorldPixelStart.resY + pixelStartY);
-    SpatialReference tile_spat = RasterCalculations::pixelToSpatialRectangle(qrect, tile_start_world_res, tile_start_world_res + qrect.tileRes);
-
-    if(lastTime > -1 && lastTime < time){
-        currRasterIndex += 1;
-        lastTime = time;
-    }
+    SpatialReference tile_spat = RasterCalculations::pixelToSpatialRectangle(scale, origin, tile_start_world_res, tile_start_world_res + qrect.tileRes);
 
-    auto getter = [index = currRasterIndex, res_left_to_fill = res_left_to_fill, fillFrom = fillFrom, fill_index = fill_with_index](const Descriptor &self) -> std::unique_ptr<Raster> {
+    auto getter = [index = rasterIndex(time), res_left_to_fill, fillFrom, pixelStartX, pixelStartY, tile_start_world_res, pattern = pattern](const Descriptor &self) -> std::unique_ptr<Raster> {
         std::unique_ptr<Raster> out = Raster::createRaster(self.dataType, self.tileResolution);
-        RasterOperations::callUnary<FakeSourceWriter>(out.get(), fillFrom, res_left_to_fill, index, self.nodata, fill_index);
+        RasterOperations::callUnary<FakeSourceWriter>(out.get(), fillFrom, res_left_to_fill, pixelStartX, pixelStartY,
+                                                      static_cast<int64_t>(tile_start_world_res.resX), static_cast<int64_t>(tile_start_world_res.resY),
+                                                      index, self.nodata, pattern.get());
         return out;
     };
 
@@ -100,6 +189,10 @@ void FakeSource::increaseCurrentTime(double &currTime) {
     currTime += timeDuration;
 }
 
+void FakeSource::advanceCurrentTime(double &currTime, uint32_t rasterCount) {
+    currTime += rasterCount * timeDuration;
+}
+
 double FakeSource::getCurrentTimeEnd(double currTime) const {
     return currTime + timeDuration;
 }
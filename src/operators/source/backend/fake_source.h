@@ -6,12 +6,41 @@
 
 namespace rts {
 
-
     /**
-     * Source operator for creating test data used to test the workflow.
-     * It is based on datasets stored on disc providing resolution and time info. Each raster has its index as data.
+     * The data a FakeSource writes into its tiles.
      */
+    enum class FakePattern {
+        //sum of the pixel position inside of the tile (x+y).
+        PixelSum,
+        //index of the raster in the dataset.
+        RasterIndex,
+        //diagonal gradient over the query raster from value_min to value_max, moving with the raster index.
+        Gradient,
+        //uniform noise between value_min and value_max.
+        Noise,
+        //every pixel of every raster is value_min.
+        Constant
+    };
 
+    /**
+     * Source operator for creating synthetic data used to test and benchmark the workflow, without files on disk.
+     * The dataset json file provides the time info: time_start, time_duration and raster_count, the data type
+     * and nodata value of the rasters. The rasters have the resolution of the query and are aligned to the origin of
+     * its projection, like rasters of the GDAL source.
+     *
+     * The data is deterministic, it only depends on the seed, the raster index and the position of the pixel. Noise,
+     * raster_index, constant and the nodata holes use the world pixel position, so the same pixel has the same value
+     * in every query and tiling. pixel_sum uses the position inside of the tile, gradient the position inside of the
+     * query raster and the constant tiles are chosen per tile, so these depend on the query and tiling.
+     * Values outside of the data type are clamped to it. The tiles are filled row by row.
+     * Optional dataset fields, that can be overridden by the params of the source operator:
+     *  - pattern: [pixel_sum, raster_index, gradient, noise, constant]. Default pixel_sum.
+     *  - seed: seed of noise, nodata holes and constant tiles. Default 0.
+     *  - value_min, value_max: value range of the gradient and noise patterns. Default 0 and 100.
+     *  - nodata_holes: share of pixels that are nodata, between 0 and 1. Default 0.
+     *  - constant_tiles: share of tiles filled with one value between value_min and value_max. Default 0.
+     * The param fill_with_index is kept as shortcut for pattern raster_index.
+     */
     class FakeSource : public SourceBackend {
     public:
         explicit FakeSource(const QueryRectangle &qrect, const Json::Value &params);
@@ -19,26 +48,41 @@ namespace rts {
         void initialize() override;
         bool supportsOrder(Order o) const override;
         Origin getOrigin() const override;
+
+        /**
+         * Settings of the generated data, shared by all tiles of the source.
+         */
+        struct PatternInfo {
+            FakePattern pattern;
+            uint64_t seed;
+            double valueMin;
+            double valueMax;
+            double nodataHoles;
+            double constantTiles;
+            //the gradient spans the query raster plus one step per raster.
+            double gradientStep;
+        };
+
     private:
-        Json::Value loadDatasetJson(std::string name);
         int rasterCount;
-        int currRasterIndex;
-        double lastTime;
         double nodata;
         GDALDataType dataType;
         double timeDuration;
-        SpatialReference extent;
         Origin origin;
+        std::shared_ptr<const PatternInfo> pattern;
 
-        /***
-         * if true the data thats written into the tile is the raster index, if false the pixel will be sum of its index (x+y)
+        static FakePattern parsePattern(const std::string &input);
+
+        /**
+         * @return Index of the raster starting at the time in the dataset.
          */
-        bool fill_with_index;
+        int rasterIndex(double time) const;
 
         /**
          * Increase the currTime variable to the time the next raster starts.
          */
         void increaseCurrentTime(double &currTime) override;
+        void advanceCurrentTime(double &currTime, uint32_t rasterCount) override;
         /**
          * Get the end time of the validity of the current raster.
          * @return
@@ -5,105 +5,147 @@
 #include "util/benchmark.h"
 #include "gdal_source.h"
 
-#include <boost/filesystem.hpp>
-#include <fstream>
 #include <ctime>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <iostream>
 #include <gdal.h>
 
 using namespace rts;
 using namespace boost::posix_time;
 
-template<class T>
-struct GdalSourceWriter {
-    static void rasterOperation(TypedRaster<T> *raster, std::shared_ptr<GDALDataset> rasterDataset,
-                                GDALRasterBand *rasterBand, const Descriptor &self,
-                                Resolution fill_from, Resolution res_left_to_fill)
-    {
-        Resolution tileRes = raster->getResolution();
-
-        //calculate where the qrect is in source raster pixels. see mappings gdalsource.
-        double adfGeoTransform[6];
-        if(rasterDataset->GetGeoTransform( adfGeoTransform ) != CE_None ) {
-            throw std::runtime_error("GDAL Source: No GeoTransform information in raster");
-        }
-
-        double origin_x = adfGeoTransform[0];
-        double origin_y = adfGeoTransform[3];
-        double scale_x = adfGeoTransform[1];
-        double scale_y = adfGeoTransform[5];
-
-        int rasterSizeX = rasterBand->GetXSize();
-        int rasterSizeY = rasterBand->GetYSize();
+/**
+ * Calculates which pixels of the GDAL raster are read for a tile.
+ */
+static GdalReadWindow calculateReadWindow(const GdalBandInfo &info,
+                                          const SpatialReference &tileSpatialInfo, const SpatialReference &rasterSpatialInfo,
+                                          const Resolution &tileRes, Resolution fill_from, Resolution res_left_to_fill)
+{
+    //calculate where the qrect is in source raster pixels. see mappings gdalsource.
+    SpatialReference spatInfo = tileSpatialInfo;
+    if(spatInfo.x1 < rasterSpatialInfo.x1)
+        spatInfo.x1 = rasterSpatialInfo.x1;
+    if(spatInfo.x2 > rasterSpatialInfo.x2)
+        spatInfo.x2 = rasterSpatialInfo.x2;
+    if(spatInfo.y1 < rasterSpatialInfo.y1)
+        spatInfo.y1 = rasterSpatialInfo.y1;
+    if(spatInfo.y2 > rasterSpatialInfo.y2)
+        spatInfo.y2 = rasterSpatialInfo.y2;
+
+    double exact_x1 = (spatInfo.x1 - info.originX) / info.scaleX;
+    double exact_y1 = (spatInfo.y1 - info.originY) / info.scaleY;
+    double exact_x2 = (spatInfo.x2 - info.originX) / info.scaleX;
+    double exact_y2 = (spatInfo.y2 - info.originY) / info.scaleY;
+
+    if (exact_x1 > exact_x2)
+        std::swap(exact_x1, exact_x2);
+    if (exact_y1 > exact_y2)
+        std::swap(exact_y1, exact_y2);
+
+    int pixel_x1 = static_cast<int>(floor(exact_x1));
+    int pixel_y1 = static_cast<int>(floor(exact_y1));
+    int pixel_x2 = static_cast<int>(floor(exact_x2));
+    int pixel_y2 = static_cast<int>(floor(exact_y2));
+
+    int gdal_pixel_x1 = std::min(info.sizeX, std::max(0, pixel_x1));
+    int gdal_pixel_y1 = std::min(info.sizeY, std::max(0, pixel_y1));
+
+    int gdal_pixel_x2 = std::min(info.sizeX, std::max(0, pixel_x2));
+    int gdal_pixel_y2 = std::min(info.sizeY, std::max(0, pixel_y2));
+
+    GdalReadWindow window;
+    window.x1 = gdal_pixel_x1;
+    window.y1 = gdal_pixel_y1;
+    window.width = gdal_pixel_x2 - gdal_pixel_x1;
+    window.height = gdal_pixel_y2 - gdal_pixel_y1;
+    window.exactX1 = std::min<double>(info.sizeX, std::max(0.0, exact_x1));
+    window.exactY1 = std::min<double>(info.sizeY, std::max(0.0, exact_y1));
+    window.exactWidth = std::min<double>(info.sizeX, std::max(0.0, exact_x2)) - window.exactX1;
+    window.exactHeight = std::min<double>(info.sizeY, std::max(0.0, exact_y2)) - window.exactY1;
+    window.fillFrom = fill_from;
+
+    window.size = tileRes - fill_from;
+    if(res_left_to_fill.resX < window.size.resX)
+        window.size.resX = res_left_to_fill.resX - fill_from.resX;
+    if(res_left_to_fill.resY < window.size.resY)
+        window.size.resY = res_left_to_fill.resY - fill_from.resY;
+    return window;
+}
 
-        //GDAL often has a positive y origin and a negative scale, but I assume the origin to be the smaller
-        //coordinate and the scale to be positive, so swap that here. use raster size for calculation of actual origin.
-        if(scale_y < 0){
-            double old_origin_y = origin_y;
-            origin_y = origin_y + scale_y * rasterSizeY;
-            scale_y *= -1;
+/**
+ * Estimates the overview GDAL reads a resampled window from: the overview with the lowest resolution that still has
+ * at least the requested resolution. GDAL lists the overviews of a sibling .ovr file as overviews of the band, too.
+ * GDAL selects the overview itself when reading, this is only used to know the blocks that are decoded.
+ * @param requestedFactor How many pixels of the band are combined to one pixel of the output.
+ * @return Index of the overview in the band info, -1 when no overview fits.
+ */
+static int bestOverview(const GdalBandInfo &info, double requestedFactor) {
+    int best = -1;
+    double bestFactor = 1;
+    if(requestedFactor <= 1)
+        return best;
+    for(size_t i = 0; i < info.overviews.size(); ++i){
+        double factor = static_cast<double>(info.sizeX) / info.overviews[i].sizeX;
+        if(factor > bestFactor && factor <= requestedFactor){
+            best = static_cast<int>(i);
+            bestFactor = factor;
         }
+    }
+    return best;
+}
 
-        SpatialReference spatInfo = self.tileSpatialInfo;
-        if(spatInfo.x1 < self.rasterInfo.x1)
-            spatInfo.x1 = self.rasterInfo.x1;
-        if(spatInfo.x2 > self.rasterInfo.x2)
-            spatInfo.x2 = self.rasterInfo.x2;
-        if(spatInfo.y1 < self.rasterInfo.y1)
-            spatInfo.y1 = self.rasterInfo.y1;
-        if(spatInfo.y2 > self.rasterInfo.y2)
-            spatInfo.y2 = self.rasterInfo.y2;
-
-        int pixel_x1 = 0;
-        int pixel_y1 = 0;
-        int pixel_x2 = rasterSizeX;
-        int pixel_y2 = rasterSizeY;
-        int pixel_width = rasterSizeX;
-        int pixel_height = rasterSizeY;
-
-        pixel_x1 = static_cast<int>(floor((spatInfo.x1 - origin_x) / scale_x));
-        pixel_y1 = static_cast<int>(floor((spatInfo.y1 - origin_y) / scale_y));
-        pixel_x2 = static_cast<int>(floor((spatInfo.x2 - origin_x) / scale_x));
-        pixel_y2 = static_cast<int>(floor((spatInfo.y2 - origin_y) / scale_y));
-
-        if (pixel_x1 > pixel_x2)
-            std::swap(pixel_x1, pixel_x2);
-        if (pixel_y1 > pixel_y2)
-            std::swap(pixel_y1, pixel_y2);
-
-        pixel_width = pixel_x2 - pixel_x1;
-        pixel_height = pixel_y2 - pixel_y1;
-
-        int gdal_pixel_x1 = std::min(rasterSizeX, std::max(0, pixel_x1));
-        int gdal_pixel_y1 = std::min(rasterSizeY, std::max(0, pixel_y1));
-
-        int gdal_pixel_x2 = std::min(rasterSizeX, std::max(0, pixel_x2));
-        int gdal_pixel_y2 = std::min(rasterSizeY, std::max(0, pixel_y2));
-
-        int gdal_pixel_width = gdal_pixel_x2 - gdal_pixel_x1;
-        int gdal_pixel_height = gdal_pixel_y2 - gdal_pixel_y1;
-
-        Resolution size = tileRes - fill_from;
-        if(res_left_to_fill.resX < size.resX)
-            size.resX = res_left_to_fill.resX - fill_from.resX;
-        if(res_left_to_fill.resY < size.resY)
-            size.resY = res_left_to_fill.resY - fill_from.resY;
-
-        if(fill_from.resX > 0 || fill_from.resY > 0 || size.resX < tileRes.resX || size.resY < tileRes.resY){
-            for (int x = 0; x < tileRes.resX; ++x) {
-                for (int y = 0; y < tileRes.resY; ++y) {
-                    raster->setCell(x,y, (T)self.nodata);
-                }
+/**
+ * Sets the whole tile to nodata if the read window does not cover it completely.
+ */
+template<class T>
+static void fillUncoveredWithNodata(TypedRaster<T> *raster, const GdalReadWindow &window, double nodata) {
+    Resolution tileRes = raster->getResolution();
+    if(window.fillFrom.resX > 0 || window.fillFrom.resY > 0 || window.size.resX < tileRes.resX || window.size.resY < tileRes.resY){
+        for (int x = 0; x < tileRes.resX; ++x) {
+            for (int y = 0; y < tileRes.resY; ++y) {
+                raster->setCell(x,y, (T)nodata);
             }
         }
+    }
+}
+
+template<class T>
+struct GdalSourceWriter {
+    static void rasterOperation(TypedRaster<T> *raster, GDALRasterBand *rasterBand, const GdalReadWindow &window, const Descriptor &self)
+    {
+        Resolution tileRes = raster->getResolution();
+        fillUncoveredWithNodata(raster, window, self.nodata);
 
         void *buffer = nullptr;
-        if(fill_from.resX > 0 || fill_from.resY > 0)
-            buffer = raster->getVoidDataPointerOffset(fill_from.resX, fill_from.resY);
+        if(window.fillFrom.resX > 0 || window.fillFrom.resY > 0)
+            buffer = raster->getVoidDataPointerOffset(window.fillFrom.resX, window.fillFrom.resY);
         else
             buffer = raster->getVoidDataPointer();
 
-        auto res = rasterBand->RasterIO(GF_Read, gdal_pixel_x1, gdal_pixel_y1, gdal_pixel_width, gdal_pixel_height,
-                buffer, size.resX, size.resY, self.dataType, 0, sizeof(T) * tileRes.resX, nullptr);
+        GDALRasterIOExtraArg extraArg;
+        INIT_RASTERIO_EXTRA_ARG(extraArg);
+        int x1 = window.x1;
+        int y1 = window.y1;
+        int width = window.width;
+        int height = window.height;
+        //resampled tiles are read from their exact window, GDAL selects the overview fitting the resolution and
+        //maps the window into it, so neighbouring tiles do not overlap or leave gaps.
+        if(width != window.size.resX || height != window.size.resY){
+            extraArg.bFloatingPointWindowValidity = TRUE;
+            extraArg.dfXOff = window.exactX1;
+            extraArg.dfYOff = window.exactY1;
+            extraArg.dfXSize = window.exactWidth;
+            extraArg.dfYSize = window.exactHeight;
+            //the integer window has to contain the exact one.
+            x1 = static_cast<int>(floor(window.exactX1));
+            y1 = static_cast<int>(floor(window.exactY1));
+            width = std::min(rasterBand->GetXSize(), static_cast<int>(ceil(window.exactX1 + window.exactWidth))) - x1;
+            height = std::min(rasterBand->GetYSize(), static_cast<int>(ceil(window.exactY1 + window.exactHeight))) - y1;
+        }
+
+        auto res = rasterBand->RasterIO(GF_Read, x1, y1, width, height,
+                buffer, window.size.resX, window.size.resY, self.dataType, 0, sizeof(T) * tileRes.resX, &extraArg);
 
         if(res != CE_None){
             throw std::runtime_error("GDAL Source: Reading from raster failed.");
@@ -111,22 +153,79 @@ struct GdalSourceWriter {
     }
 };
 
+/**
+ * A rectangle of the GDAL raster that is read with a single RasterIO call for several tiles returned by
+ * createDescriptors. It is read when the first of the tiles is loaded and freed with the last descriptor.
+ */
+struct GdalBlock {
+    std::shared_ptr<GdalDatasetPool> pool;
+    std::string path;
+    int channel;
+    GDALDataType dataType;
+    int x1;
+    int y1;
+    int width;
+    int height;
+    std::vector<char> data;
+    std::once_flag loaded;
+
+    void load() {
+        std::call_once(loaded, [this](){
+            std::vector<char> buffer(static_cast<size_t>(width) * height * GDALGetDataTypeSizeBytes(dataType));
+            GdalDatasetPool::Lease dataset = pool->lease(path);
+            auto res = dataset->GetRasterBand(channel)->RasterIO(GF_Read, x1, y1, width, height, buffer.data(), width, height, dataType, 0, 0, nullptr);
+            if(res != CE_None){
+                throw std::runtime_error("GDAL Source: Reading from raster failed.");
+            }
+            data = std::move(buffer);
+        });
+    }
+};
+
+template<class T>
+struct GdalBlockCopier {
+    static void rasterOperation(TypedRaster<T> *raster, GdalBlock *block, const GdalReadWindow &window, double nodata)
+    {
+        block->load();
+        fillUncoveredWithNodata(raster, window, nodata);
+
+        const T *blockData = reinterpret_cast<const T*>(block->data.data());
+        for(uint32_t y = 0; y < window.size.resY; ++y){
+            const T *src = blockData + static_cast<size_t>(window.y1 - block->y1 + y) * block->width + (window.x1 - block->x1);
+            T *dst = static_cast<T*>(raster->getVoidDataPointerOffset(window.fillFrom.resX, window.fillFrom.resY + y));
+            std::copy(src, src + window.size.resX, dst);
+        }
+    }
+};
+
 
-GDALSource::GDALSource(const QueryRectangle &qrect, const Json::Value &params)
-        : SourceBackend(qrect, params), currDataset(nullptr), currRasterband(nullptr), currDatasetTime(0)
+GDALSource::GDALSource(const OperatorTree *operatorTree, const QueryRectangle &qrect, const Json::Value &params)
+        : SourceBackend(qrect, params), operatorTree(operatorTree), currDatasetTime(0),
+          readPixels(0), decodedPixels(0), blockSize(0, 0)
 {
 
 }
 
+GDALSource::~GDALSource() {
+    //only warned once, re-instantiated operators of the same query would repeat it.
+    static std::once_flag warned;
+    if(getReadAmplification() > MAX_READ_AMPLIFICATION){
+        std::call_once(warned, [this](){
+            std::cerr << "GDAL Source: reading the tiles decodes " << getReadAmplification() << " times the pixels of the tiles, "
+                      << "because they do not cover whole blocks of " << blockSize.resX << "x" << blockSize.resY << " pixels. "
+                      << "Set tileRes to \"auto\" to align the tiles to the blocks.\n";
+        });
+    }
+}
+
 void GDALSource::initialize() {
     GDALUtil::initGdal();
 
-    Json::Value dataset_json    = loadDatasetJson(params["dataset"].asString());
+    dataset                     = DatasetCatalog::getGdalSourceDataset(params["dataset"].asString());
+    const Json::Value &dataset_json = dataset->json;
     channel                     = dataset_json["channel"].asInt();
+    datasetPool                 = operatorTree->getDatasetPool(params.get("max_open_datasets", 64).asUInt64());
 
-    baseFileName                = dataset_json["filename"].asString();
-    path                        = dataset_json["path"].asString();
-    timeFormat                  = dataset_json["time_format"].asString();
 
     Json::Value time_interval_json   = dataset_json["time_interval"];
     timeInterval = TimeInterval(time_interval_json);
@@ -149,43 +248,143 @@ void GDALSource::initialize() {
 
 OptionalDescriptor GDALSource::createDescriptor(double time, int pixelStartX, int pixelStartY, int tileIndex, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin, const Resolution &tileCount) {
 
-    if(currDataset == nullptr || time != currDatasetTime){
+    if(currDatasetPath.empty() || time != currDatasetTime){
+        loadCurrentGdalDataset(time);
+    }
+    const TileReadPlan &plan = getTileReadPlan(pixelStartX, pixelStartY, tileIndex, rasterWorldPixelStart, scale, origin);
+    trackReadAmplification(*currBandInfo, plan.window);
+
+    //the getter leases its own dataset, so getters can be called from multiple threads at once.
+    auto getter = [pool = datasetPool, path = currDatasetPath, channel = channel, window = plan.window](const Descriptor &self) -> std::unique_ptr<Raster> {
+        Benchmark::startSource();
+        std::unique_ptr<Raster> out = Raster::createRaster(self.dataType, self.tileResolution);
+        GdalDatasetPool::Lease dataset = pool->lease(path);
+        GDALRasterBand *rasterBand = dataset->GetRasterBand(channel);
+        RasterOperations::callUnary<GdalSourceWriter>(out.get(), rasterBand, window, self);
+        Benchmark::endSource();
+        return out;
+    };
+
+    return createTileDescriptor(std::move(getter), *currBandInfo, time, plan.geometry.tileSpatialInfo, tileIndex, tileCount);
+}
+
+OptionalDescriptorVector GDALSource::createDescriptors(double time, const std::vector<Resolution> &pixelStarts, const std::vector<int> &tileIndices, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin, const Resolution &tileCount) {
+
+    if(currDatasetPath.empty() || time != currDatasetTime){
         loadCurrentGdalDataset(time);
     }
 
-    double nodata = currRasterband->GetNoDataValue();
-    GDALDataType dataType = currRasterband->GetRasterDataType();
+    //look up the read windows of all tiles. When every tile is read without resampling, all of them are copied
+    //from one block covering the windows, read with a single RasterIO call instead of one per tile.
+    std::vector<TileReadPlan> plans;
+    plans.reserve(tileIndices.size());
+    bool coalesce = tileIndices.size() > 1;
+    int blockX1 = std::numeric_limits<int>::max();
+    int blockY1 = std::numeric_limits<int>::max();
+    int blockX2 = std::numeric_limits<int>::min();
+    int blockY2 = std::numeric_limits<int>::min();
+    uint64_t windowArea = 0;
+
+    for(size_t i = 0; i < tileIndices.size(); ++i){
+        plans.push_back(getTileReadPlan(pixelStarts[i].resX, pixelStarts[i].resY, tileIndices[i], rasterWorldPixelStart, scale, origin));
+        const GdalReadWindow &window = plans.back().window;
+
+        if(window.width <= 0 || window.height <= 0 || window.width != window.size.resX || window.height != window.size.resY){
+            coalesce = false;
+            continue;
+        }
+        blockX1 = std::min(blockX1, window.x1);
+        blockY1 = std::min(blockY1, window.y1);
+        blockX2 = std::max(blockX2, window.x1 + window.width);
+        blockY2 = std::max(blockY2, window.y1 + window.height);
+        windowArea += static_cast<uint64_t>(window.width) * window.height;
+    }
+
+    //tiles far apart from each other would read a lot of pixels between them that are not needed.
+    uint64_t blockArea = coalesce ? static_cast<uint64_t>(blockX2 - blockX1) * (blockY2 - blockY1) : 0;
+    if(!coalesce || blockArea > 2 * windowArea){
+        return SourceBackend::createDescriptors(time, pixelStarts, tileIndices, rasterWorldPixelStart, scale, origin, tileCount);
+    }
+
+    auto block = std::make_shared<GdalBlock>();
+    block->pool = datasetPool;
+    block->path = currDatasetPath;
+    block->channel = channel;
+    block->dataType = currBandInfo->dataType;
+    block->x1 = blockX1;
+    block->y1 = blockY1;
+    block->width = blockX2 - blockX1;
+    block->height = blockY2 - blockY1;
+    GdalReadWindow blockWindow = {};
+    blockWindow.x1 = block->x1;
+    blockWindow.y1 = block->y1;
+    blockWindow.width = block->width;
+    blockWindow.height = block->height;
+    blockWindow.size = Resolution(block->width, block->height);
+    trackReadAmplification(*currBandInfo, blockWindow);
+
+    OptionalDescriptorVector result;
+    result.reserve(tileIndices.size());
+    for(size_t i = 0; i < tileIndices.size(); ++i){
+        auto getter = [block, window = plans[i].window](const Descriptor &self) -> std::unique_ptr<Raster> {
+            Benchmark::startSource();
+            std::unique_ptr<Raster> out = Raster::createRaster(self.dataType, self.tileResolution);
+            RasterOperations::callUnary<GdalBlockCopier>(out.get(), block.get(), window, self.nodata);
+            Benchmark::endSource();
+            return out;
+        };
+        result.emplace_back(createTileDescriptor(std::move(getter), *currBandInfo, time, plans[i].geometry.tileSpatialInfo, tileIndices[i], tileCount));
+    }
+    return result;
+}
 
-    Resolution fillFrom(0, 0);
+GDALSource::TileGeometry GDALSource::calculateTileGeometry(int pixelStartX, int pixelStartY, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin) const {
+    TileGeometry geometry;
 
     //fillFrom: for fixed alignment of tiles, start of a tile is not always 0, based on what pixel in world space the tile starts.
     if(pixelStartX < 0){
-        fillFrom.resX = (uint32_t)(-1 * pixelStartX);
+        geometry.fillFrom.resX = (uint32_t)(-1 * pixelStartX);
     }
     if(pixelStartY < 0){
-        fillFrom.resY = (uint32_t)(-1 * pixelStartY);
+        geometry.fillFrom.resY = (uint32_t)(-1 * pixelStartY);
     }
 
     //total pixel left to fill, may be bigger as tileSize
-    Resolution resLeftToFill(qrect.resX - pixelStartX, qrect.resY - pixelStartY); //pixelInTileLeftToFill
+    geometry.resLeftToFill = Resolution(qrect.resX - pixelStartX, qrect.resY - pixelStartY); //pixelInTileLeftToFill
 
     Resolution tileStartWorldRes(rasterWorldPixelStart.resX + pixelStartX, rasterWorldPixelStart.resY + pixelStartY);
-    SpatialReference tileSpat = RasterCalculations::pixelToSpatialRectangle(scale, origin, tileStartWorldRes, tileStartWorldRes + qrect.tileRes);
+    geometry.tileSpatialInfo = RasterCalculations::pixelToSpatialRectangle(scale, origin, tileStartWorldRes, tileStartWorldRes + qrect.tileRes);
+    return geometry;
+}
 
-    auto getter = [currDataset = currDataset, currRasterband = currRasterband, fillFrom = fillFrom, resLeftToFill = resLeftToFill](const Descriptor &self) -> std::unique_ptr<Raster> {
-        Benchmark::startSource();
-        std::unique_ptr<Raster> out = Raster::createRaster(self.dataType, self.tileResolution);
-        RasterOperations::callUnary<GdalSourceWriter>(out.get(), currDataset, currRasterband, self, fillFrom, resLeftToFill);
-        Benchmark::endSource();
-        return out;
-    };
+const GDALSource::TileReadPlan& GDALSource::getTileReadPlan(int pixelStartX, int pixelStartY, int tileIndex, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin) {
+    //the windows only depend on the geometry of the files, usually all files of a dataset share it.
+    if(tilePlansInfo == nullptr || !tilePlansInfo->sameGeometry(*currBandInfo)){
+        tilePlans.clear();
+        tilePlansInfo = currBandInfo;
+    }
+    if(static_cast<size_t>(tileIndex) >= tilePlans.size())
+        tilePlans.resize(tileIndex + 1);
+
+    TileReadPlan &plan = tilePlans[tileIndex];
+    if(!plan.planned){
+        plan.geometry = calculateTileGeometry(pixelStartX, pixelStartY, rasterWorldPixelStart, scale, origin);
+        plan.window = calculateReadWindow(*currBandInfo, plan.geometry.tileSpatialInfo, qrect, qrect.tileRes, plan.geometry.fillFrom, plan.geometry.resLeftToFill);
+        plan.planned = true;
+    }
+    return plan;
+}
+
+OptionalDescriptor GDALSource::createTileDescriptor(std::function<UniqueRaster(const Descriptor&)> &&getter, const GdalBandInfo &info, double time, const SpatialReference &tileSpatialInfo, int tileIndex, const Resolution &tileCount) {
+    double nodata = info.nodata;
+    GDALDataType dataType = info.dataType;
 
     TemporalReference tempInfo(time, getCurrentTimeEnd(time));
     SpatialTemporalReference rasterInfo = qrect;
     rasterInfo.t1 = tempInfo.t1;
     rasterInfo.t2 = tempInfo.t2;
 
-    return rts::make_optional<Descriptor>(std::move(getter), rasterInfo, tileSpat, qrect.tileRes,
+    return rts::make_optional<Descriptor>(std::move(getter), rasterInfo, tileSpatialInfo, qrect.tileRes,
                                           qrect.order, tileIndex, tileCount, nodata, dataType);
 }
 
@@ -193,8 +392,65 @@ Origin GDALSource::getOrigin() const {
     return origin;
 }
 
+Resolution GDALSource::getNativeBlockSize() {
+    if(currDatasetPath.empty())
+        loadCurrentGdalDataset(datasetStartTime);
+    const GdalBandInfo &info = *currBandInfo;
+
+    //how many pixels of the file are combined to one pixel of the query.
+    double factorX = (qrect.x2 - qrect.x1) / qrect.resX / std::abs(info.scaleX);
+    double factorY = (qrect.y2 - qrect.y1) / qrect.resY / info.scaleY;
+    int overview = bestOverview(info, std::min(factorX, factorY));
+
+    int blockX = info.blockX;
+    int blockY = info.blockY;
+    double overviewFactorX = 1;
+    double overviewFactorY = 1;
+    if(overview >= 0){
+        blockX = info.overviews[overview].blockX;
+        blockY = info.overviews[overview].blockY;
+        overviewFactorX = static_cast<double>(info.sizeX) / info.overviews[overview].sizeX;
+        overviewFactorY = static_cast<double>(info.sizeY) / info.overviews[overview].sizeY;
+    }
+    return Resolution(static_cast<uint32_t>(std::max(1L, std::lround(blockX * overviewFactorX / factorX))),
+                      static_cast<uint32_t>(std::max(1L, std::lround(blockY * overviewFactorY / factorY))));
+}
+
+double GDALSource::getReadAmplification() const {
+    return readPixels > 0 ? static_cast<double>(decodedPixels) / readPixels : 1;
+}
+
+void GDALSource::trackReadAmplification(const GdalBandInfo &info, const GdalReadWindow &window) {
+    if(window.width <= 0 || window.height <= 0 || window.size.resX == 0 || window.size.resY == 0)
+        return;
+    int x1 = window.x1;
+    int y1 = window.y1;
+    int width = window.width;
+    int height = window.height;
+    int overview = bestOverview(info, std::min(static_cast<double>(width) / window.size.resX, static_cast<double>(height) / window.size.resY));
+    if(overview >= 0){
+        //the window in the pixels of the overview.
+        double scaleX = static_cast<double>(info.overviews[overview].sizeX) / info.sizeX;
+        double scaleY = static_cast<double>(info.overviews[overview].sizeY) / info.sizeY;
+        x1 = static_cast<int>(floor(window.exactX1 * scaleX));
+        y1 = static_cast<int>(floor(window.exactY1 * scaleY));
+        width = std::max(1, static_cast<int>(ceil((window.exactX1 + window.exactWidth) * scaleX)) - x1);
+        height = std::max(1, static_cast<int>(ceil((window.exactY1 + window.exactHeight) * scaleY)) - y1);
+    }
+    int blockX = overview >= 0 ? info.overviews[overview].blockX : info.blockX;
+    int blockY = overview >= 0 ? info.overviews[overview].blockY : info.blockY;
+    if(blockX <= 0 || blockY <= 0)
+        return;
+    uint64_t blocksX = static_cast<uint64_t>((x1 + width - 1) / blockX - x1 / blockX + 1);
+    uint64_t blocksY = static_cast<uint64_t>((y1 + height - 1) / blockY - y1 / blockY + 1);
+    readPixels += static_cast<uint64_t>(width) * height;
+    decodedPixels += blocksX * blocksY * blockX * blockY;
+    blockSize = Resolution(blockX, blockY);
+}
+
 void GDALSource::beforeTemporalIncrease(){
-    currDataset = nullptr;
+    currDatasetPath.clear();
+    currBandInfo = nullptr;
 }
 
 bool GDALSource::supportsOrder(Order o) const {
@@ -202,26 +458,30 @@ bool GDALSource::supportsOrder(Order o) const {
 }
 
 void GDALSource::increaseCurrentTime(double &currTime) {
+    advanceCurrentTime(currTime, 1);
+}
+
+void GDALSource::advanceCurrentTime(double &currTime, uint32_t rasterCount) {
+    //the times of the files are looked up, only times outside of the dataset are calculated.
+    int index = dataset->findFile(currTime);
+    if(index >= 0 && index + rasterCount < dataset->files.size()){
+        currTime = dataset->files[index + rasterCount].timeStart;
+        return;
+    }
     ptime currPTime = from_time_t((time_t)currTime);
-    timeInterval.increase(currPTime);
+    timeInterval.increase(currPTime, rasterCount);
     currTime = (double)to_time_t(currPTime);
 }
 
 double GDALSource::getCurrentTimeEnd(double currTime) const {
+    int index = dataset->findFile(currTime);
+    if(index >= 0)
+        return dataset->files[index].timeEnd;
     ptime currPTime = from_time_t((time_t)currTime);
     timeInterval.increase(currPTime);
     return static_cast<double>(to_time_t(currPTime));
 }
 
-Json::Value GDALSource::loadDatasetJson(const std::string &name) {
-    boost::filesystem::path p("../../test/data/gdal_source");
-    p /= name + ".json";
-    std::ifstream file_in(p.string());
-    Json::Value dataset_json;
-    file_in >> dataset_json;
-    return dataset_json;
-}
-
 double GDALSource::parseIsoTime(const std::string &str) const {
     std::tm tm = {};
     if (strptime(str.c_str(), "%Y-%m-%dT%H:%M:%S", &tm))
@@ -230,39 +490,16 @@ double GDALSource::parseIsoTime(const std::string &str) const {
         throw std::runtime_error("Could not parse time.");
 }
 
+std::string GDALSource::getFileIdentity(double time) {
+    int index = dataset->findFile(time);
+    return fileIdentity(index >= 0 ? dataset->files[index].path : DatasetCatalog::gdalFilePath(dataset->json, time));
+}
+
 void GDALSource::loadCurrentGdalDataset(double time) {
     currDatasetTime = time;
-    std::string timeString = GDALUtil::timeToString((time_t)time, timeFormat);
-
-    std::string placeholder = "%%%TIME_STRING%%%";
-    size_t placeholderPos = baseFileName.find(placeholder);
-
-    std::string fileName = baseFileName;
-    fileName.replace(placeholderPos, placeholder.length(), timeString);
-
-    if(openDatasets.find(fileName) != openDatasets.end())
-    {
-        currDataset = openDatasets[fileName];
-        currRasterband = currDataset->GetRasterBand(channel);
-    }
-    else
-    {
-        boost::filesystem::path file_path(path.c_str());
-        file_path /= fileName; //i dont get how you can not append a std::filesystem::path with a std::string ?!?!
-
-        auto dataset = (GDALDataset *)GDALOpen(file_path.c_str(), GA_ReadOnly);
-        if(dataset == nullptr){
-            throw std::runtime_error("GDAL dataset could not be opened: " + file_path.string());
-        }
-        currRasterband = dataset->GetRasterBand(channel);
-
-        currDataset = std::shared_ptr<GDALDataset>(dataset, [](GDALDataset *d){
-            GDALClose(d);
-            d = nullptr;
-        });
-        //cache the dataset when its spatial order.
-        if(qrect.order == Order::Spatial)
-            openDatasets[fileName] = currDataset;
-    }
+    int index = dataset->findFile(time);
 
+    //the file is leased from the pool when it is used, the pool keeps it open for all sources of the query.
+    currDatasetPath = index >= 0 ? dataset->files[index].path : DatasetCatalog::gdalFilePath(dataset->json, time);
+    currBandInfo = datasetPool->getBandInfo(currDatasetPath, channel);
 }
@@ -5,41 +5,139 @@
 #include "operators/source/source_operator.h"
 #include "util/gdal_util.h"
 #include "util/time_interval.h"
+#include "util/gdal_dataset_pool.h"
+#include "util/dataset_catalog.h"
 #include <gdal_priv.h>
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 namespace rts {
 
+    /**
+     * The pixels of the GDAL raster read for a tile and where they are written to in the tile.
+     */
+    struct GdalReadWindow {
+        int x1;
+        int y1;
+        int width;
+        int height;
+        //the window in fractional pixels of the band, used when the tile is resampled.
+        double exactX1;
+        double exactY1;
+        double exactWidth;
+        double exactHeight;
+        Resolution fillFrom;
+        Resolution size;
+    };
+
     /**
      * Source operator loading rasters with the GDAL library. This supports any raster format supported by GDAL.
      * A GDALSource dataset is defined by a start and end point, and a time interval (time unit and value).
      * Therefore it represents rasters that are valid in regular time intervals.
+     *
+     * When the query resolution is coarser than the files, RasterIO reads the tiles from the overview of the file that
+     * fits the query, so fewer pixels are read. The exact fractional window of a tile is passed to GDAL, so tiles read
+     * from overviews do not snap to whole overview pixels and have no seams between them. Internal overviews and
+     * sibling .ovr files are used, they can be created with rts_build_overviews.
+     *
+     * GDAL decodes the whole blocks of the files that a tile touches. The source counts the decoded pixels of the
+     * created tiles and warns when they are much more than the pixels of the tiles, e.g. because the tiles are
+     * smaller than the blocks or not aligned to them. A tileRes of "auto" in the query rectangle avoids that.
+     *
+     * The files are opened by the GdalDatasetPool of the query. Every getter leases a dataset of its file for reading
+     * the tile, so getters of tiles of the same or of different files can be called from multiple threads at once.
+     * The metadata of the files is read once by the pool as GdalBandInfo. The read windows of the tiles are calculated
+     * once per tile index and reused for all files with the same geometry.
+     * The dataset is loaded from the DatasetCatalog, the file of a time is looked up in its sorted list of files.
      */
     class GDALSource : public SourceBackend {
     public:
-        GDALSource(const QueryRectangle &qrect, const Json::Value &params);
+        GDALSource(const OperatorTree *operatorTree, const QueryRectangle &qrect, const Json::Value &params);
+        ~GDALSource() override;
 
         void initialize() override;
         bool supportsOrder(Order o) const override;
         OptionalDescriptor createDescriptor(double time, int pixelStartX, int pixelStartY, int tileIndex, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin, const Resolution &tileCount) override;
+        /**
+         * Loads the dataset once for all tiles. When the tiles are read without resampling and lie close together,
+         * the pixels of all tiles are read with a single RasterIO call on the first load and copied into the tiles.
+         */
+        OptionalDescriptorVector createDescriptors(double time, const std::vector<Resolution> &pixelStarts, const std::vector<int> &tileIndices, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin, const Resolution &tileCount) override;
         double getCurrentTimeEnd(double currTime) const override;
         void increaseCurrentTime(double &currTime) override;
+        void advanceCurrentTime(double &currTime, uint32_t rasterCount) override;
         void beforeTemporalIncrease() override;
         Origin getOrigin() const override;
+
+        /**
+         * Block size of the band, or of the overview used at the query resolution, in query pixels.
+         * Opens the first raster of the dataset when no raster was opened yet.
+         */
+        Resolution getNativeBlockSize() override;
+
+        /**
+         * The path and modification time of the file of the raster.
+         */
+        std::string getFileIdentity(double time) override;
+
+        /**
+         * @return The pixels of the blocks decoded for the tiles created so far, divided by the pixels of those tiles.
+         */
+        double getReadAmplification() const;
+
+        /**
+         * The read amplification above which a warning is printed when the source is destructed.
+         */
+        static constexpr double MAX_READ_AMPLIFICATION = 2.0;
     private:
-        std::shared_ptr<GDALDataset> currDataset;
-        GDALRasterBand *currRasterband; //this can stay a normal ptr, because it is handled by the dataset. The dataset now always has to live as long as the rasterband. maybe put them in one structure?
+        /**
+         * Position of a tile in the output raster.
+         */
+        struct TileGeometry {
+            Resolution fillFrom;
+            Resolution resLeftToFill;
+            SpatialReference tileSpatialInfo;
+        };
+
+        /**
+         * How a tile is read from a file: the window in the pixels of the band.
+         */
+        struct TileReadPlan {
+            bool planned = false;
+            TileGeometry geometry;
+            GdalReadWindow window;
+        };
+
+        /**
+         * @return The read plan of the tile for the current file, calculated on the first call for the tile index.
+         */
+        const TileReadPlan& getTileReadPlan(int pixelStartX, int pixelStartY, int tileIndex, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin);
+
+        /**
+         * Adds the pixels of a read window and of the blocks it touches to the read amplification. Resampled windows
+         * count the blocks of the overview GDAL is expected to read them from.
+         */
+        void trackReadAmplification(const GdalBandInfo &info, const GdalReadWindow &window);
+
+        TileGeometry calculateTileGeometry(int pixelStartX, int pixelStartY, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin) const;
+        OptionalDescriptor createTileDescriptor(std::function<UniqueRaster(const Descriptor&)> &&getter, const GdalBandInfo &info, double time, const SpatialReference &tileSpatialInfo, int tileIndex, const Resolution &tileCount);
+
+        const OperatorTree *operatorTree;
+        std::shared_ptr<GdalDatasetPool> datasetPool;
+        std::string currDatasetPath; //empty when the path of the current raster has to be calculated
+        std::shared_ptr<const GdalBandInfo> currBandInfo;
         double currDatasetTime;
+        //read plans by tile index, valid for files with the geometry of tilePlansInfo.
+        std::vector<TileReadPlan> tilePlans;
+        std::shared_ptr<const GdalBandInfo> tilePlansInfo;
 
+        std::shared_ptr<const CatalogDataset> dataset;
         TimeInterval timeInterval;
-        std::string timeFormat;
-        std::string baseFileName;
-        std::string path;
         int channel;
+        uint64_t readPixels;
+        uint64_t decodedPixels;
+        Resolution blockSize;
         Origin origin;
-        std::map<std::string, std::shared_ptr<GDALDataset>> openDatasets;
 
-        Json::Value loadDatasetJson(const std::string &name);
         double parseIsoTime(const std::string &str) const;
         void loadCurrentGdalDataset(double time);
     };
@@ -1,10 +1,26 @@
 
+#include <boost/filesystem.hpp>
 #include "source_backend.h"
 
 rts::SourceBackend::SourceBackend(const rts::QueryRectangle &qrect, const Json::Value &params) : qrect(qrect), params(params) {
 
 }
 
+rts::OptionalDescriptorVector rts::SourceBackend::createDescriptors(double time, const std::vector<Resolution> &pixelStarts, const std::vector<int> &tileIndices, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin, const Resolution &tileCount) {
+    OptionalDescriptorVector result;
+    result.reserve(tileIndices.size());
+    for(size_t i = 0; i < tileIndices.size(); ++i){
+        result.emplace_back(createDescriptor(time, pixelStarts[i].resX, pixelStarts[i].resY, tileIndices[i], rasterWorldPixelStart, scale, origin, tileCount));
+    }
+    return result;
+}
+
+void rts::SourceBackend::advanceCurrentTime(double &currTime, uint32_t rasterCount) {
+    for(uint32_t i = 0; i < rasterCount; ++i){
+        increaseCurrentTime(currTime);
+    }
+}
+
 void rts::SourceBackend::beforeTemporalIncrease() {
 
 }
@@ -13,3 +29,23 @@ void rts::SourceBackend::beforeSpatialIncrease() {
 
 }
 
+
+rts::Resolution rts::SourceBackend::getNativeBlockSize() {
+    return Resolution(0, 0);
+}
+
+bool rts::SourceBackend::hasFixedTileResolution() {
+    return false;
+}
+
+std::string rts::SourceBackend::getFileIdentity(double time) {
+    return "";
+}
+
+std::string rts::SourceBackend::fileIdentity(const std::string &path) {
+    boost::system::error_code ec;
+    std::time_t modified = boost::filesystem::last_write_time(path, ec);
+    if(ec)
+        return path;
+    return path + "@" + std::to_string(modified);
+}
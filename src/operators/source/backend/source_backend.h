@@ -11,6 +11,7 @@ namespace rts {
     class SourceBackend {
     public:
         SourceBackend(const QueryRectangle &qrect, const Json::Value &params);
+        virtual ~SourceBackend() = default;
 
         virtual void initialize() = 0;
         virtual bool supportsOrder(Order o) const = 0;
@@ -25,6 +26,17 @@ namespace rts {
          */
         virtual OptionalDescriptor createDescriptor(double time, int pixelStartX, int pixelStartY, int tileIndex, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin, const Resolution &tileCount) = 0;
 
+        /**
+         * Method for returning the descriptors of several tiles of the same raster, used by getDescriptors().
+         * The default calls createDescriptor() for every tile, backends can override it to share the work between
+         * the tiles, e.g. loading the dataset once and reading adjacent tiles together.
+         * @param time The time identifying the raster to be used.
+         * @param pixelStarts pixel positions from where to return the tiles.
+         * @param tileIndices indices of the tiles, same length as pixelStarts.
+         * @return Descriptors for the tiles in the order of tileIndices.
+         */
+        virtual OptionalDescriptorVector createDescriptors(double time, const std::vector<Resolution> &pixelStarts, const std::vector<int> &tileIndices, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin, const Resolution &tileCount);
+
         virtual void beforeSpatialIncrease();
         virtual void beforeTemporalIncrease();
         /**
@@ -32,6 +44,12 @@ namespace rts {
          */
         virtual void increaseCurrentTime(double &currTime) = 0;
 
+        /**
+         * Increase the currTime variable by several rasters at once, without loading the rasters in between.
+         * The default calls increaseCurrentTime() rasterCount times.
+         */
+        virtual void advanceCurrentTime(double &currTime, uint32_t rasterCount);
+
         /**
          * Get the end time of the validity of the current raster.
          * @return The exclusive end time of the raster's temporal validity.
@@ -43,6 +61,25 @@ namespace rts {
          */
         virtual Origin getOrigin() const = 0;
 
+        /**
+         * Size of the blocks the data of the dataset is stored in, in pixels of the query resolution, rounded.
+         * Reading a part of a block decodes the whole block, so tiles should cover whole blocks.
+         * Can be called after initialize(). The default returns (0,0) for backends without a block layout.
+         */
+        virtual Resolution getNativeBlockSize();
+
+        /**
+         * @return True when queries must use the native block size as tileRes, so the "auto" tile resolution is
+         * exactly the block size. The default returns false.
+         */
+        virtual bool hasFixedTileResolution();
+
+        /**
+         * Identifies the file the raster starting at the time is read from, so the disk tile cache does not return
+         * tiles of a file that was replaced or changed. The default returns an empty string for backends without files.
+         */
+        virtual std::string getFileIdentity(double time);
+
         /**
          * The start time of the dataset used by the operator.
          */
@@ -53,6 +90,11 @@ namespace rts {
         double datasetEndTime;
 
     protected:
+        /**
+         * @return The path and the modification time of the file, only the path if the file does not exist.
+         */
+        static std::string fileIdentity(const std::string &path);
+
         const Json::Value &params;
         const QueryRectangle &qrect;
     };
@@ -0,0 +1,142 @@
+#include <cmath>
+#include <limits>
+#include <boost/filesystem.hpp>
+#include "datatypes/raster_operations.h"
+#include "util/raster_calculations.h"
+#include "util/dataset_catalog.h"
+#include "util/benchmark.h"
+#include "time_cube_source.h"
+
+using namespace rts;
+
+/**
+ * Sets the pixels of the tile outside of the query to nodata.
+ */
+template<class T>
+struct TimeCubeEdgeFiller {
+    static void rasterOperation(TypedRaster<T> *raster, Resolution fillFrom, Resolution resLeftToFill, double nodata) {
+        Resolution res = raster->getResolution();
+        for (int y = 0; y < res.resY; ++y) {
+            for (int x = 0; x < res.resX; ++x) {
+                if(x < fillFrom.resX || y < fillFrom.resY || x >= resLeftToFill.resX || y >= resLeftToFill.resY)
+                    raster->setCell(x, y, (T)nodata);
+            }
+        }
+    }
+};
+
+TimeCubeSource::TimeCubeSource(const QueryRectangle &qrect, const Json::Value &params) : SourceBackend(qrect, params)
+{
+
+}
+
+void TimeCubeSource::initialize() {
+    boost::filesystem::path path(DatasetCatalog::getRoot());
+    path /= "time_cube";
+    path /= params["dataset"].asString() + ".cube";
+    cubePath = path.string();
+    cube = TimeCube::open(cubePath);
+    const TimeCubeLayout &layout = cube->getLayout();
+
+    //the tile resolution is not known yet when the "auto" tile resolution is calculated, it is the one of the cube.
+    double scaleX = (qrect.x2 - qrect.x1) / qrect.resX;
+    double scaleY = (qrect.y2 - qrect.y1) / qrect.resY;
+    if(std::abs(scaleX - layout.scale.x) > 1e-9 * std::abs(layout.scale.x) || std::abs(scaleY - layout.scale.y) > 1e-9 * std::abs(layout.scale.y)
+       || (!qrect.hasAutoTileRes() && !qrect.tileRes.equalsResolution(layout.tileRes)))
+    {
+        throw std::runtime_error("Time Cube Source: the pixel size and tileRes of the query must be the ones of the cube, "
+                                 + std::to_string(layout.tileRes.resX) + "x" + std::to_string(layout.tileRes.resY) + " pixels per tile.");
+    }
+
+    if(layout.times.empty()){
+        datasetStartTime = 0;
+        datasetEndTime = -1;
+    } else {
+        datasetStartTime = layout.times.front().t1;
+        datasetEndTime = layout.times.back().t1;
+    }
+}
+
+OptionalDescriptor TimeCubeSource::createDescriptor(double time, int pixelStartX, int pixelStartY, int tileIndex, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin, const Resolution &tileCount) {
+    const TimeCubeLayout &layout = cube->getLayout();
+
+    Resolution fillFrom(0, 0);
+    if(pixelStartX < 0)
+        fillFrom.resX = (uint32_t)(-1 * pixelStartX);
+    if(pixelStartY < 0)
+        fillFrom.resY = (uint32_t)(-1 * pixelStartY);
+    Resolution resLeftToFill(qrect.resX - pixelStartX, qrect.resY - pixelStartY);
+
+    Resolution tileStartWorldRes(rasterWorldPixelStart.resX + pixelStartX, rasterWorldPixelStart.resY + pixelStartY);
+    SpatialReference tileSpatialInfo = RasterCalculations::pixelToSpatialRectangle(scale, origin, tileStartWorldRes, tileStartWorldRes + qrect.tileRes);
+
+    //the tiles of the query are tiles of the world tile grid, so they are whole tiles of the cube.
+    int timeIndex = layout.findTime(time);
+    uint32_t worldTileX = tileStartWorldRes.resX / layout.tileRes.resX;
+    uint32_t worldTileY = tileStartWorldRes.resY / layout.tileRes.resY;
+    bool inCube = timeIndex >= 0 && worldTileX >= layout.firstTile.resX && worldTileX - layout.firstTile.resX < layout.tileCount.resX
+                  && worldTileY >= layout.firstTile.resY && worldTileY - layout.firstTile.resY < layout.tileCount.resY;
+    uint32_t cubeTileIndex = inCube ? (worldTileY - layout.firstTile.resY) * layout.tileCount.resX + (worldTileX - layout.firstTile.resX) : 0;
+    bool atEdge = fillFrom.resX > 0 || fillFrom.resY > 0 || resLeftToFill.resX < qrect.tileRes.resX || resLeftToFill.resY < qrect.tileRes.resY;
+
+    auto getter = [cube = cube, cubeTileIndex, timeIndex, inCube, atEdge, fillFrom, resLeftToFill](const Descriptor &self) -> std::unique_ptr<Raster> {
+        Benchmark::startSource();
+        std::unique_ptr<Raster> out;
+        if(inCube){
+            out = cube->readTile(cubeTileIndex, static_cast<uint32_t>(timeIndex));
+            if(atEdge)
+                RasterOperations::callUnary<TimeCubeEdgeFiller>(out.get(), fillFrom, resLeftToFill, self.nodata);
+        } else {
+            out = Raster::createRaster(self.dataType, self.tileResolution);
+            RasterOperations::callUnary<RasterOperations::AllValuesSetter>(out.get(), self.nodata);
+        }
+        Benchmark::endSource();
+        return out;
+    };
+
+    SpatialTemporalReference rasterInfo = qrect;
+    rasterInfo.t1 = time;
+    rasterInfo.t2 = getCurrentTimeEnd(time);
+
+    return rts::make_optional<Descriptor>(std::move(getter), rasterInfo, tileSpatialInfo, qrect.tileRes, qrect.order,
+                                          tileIndex, tileCount, layout.nodata, layout.dataType);
+}
+
+bool TimeCubeSource::supportsOrder(Order o) const {
+    return o == Order::Spatial || o == Order::Temporal;
+}
+
+void TimeCubeSource::increaseCurrentTime(double &currTime) {
+    advanceCurrentTime(currTime, 1);
+}
+
+void TimeCubeSource::advanceCurrentTime(double &currTime, uint32_t rasterCount) {
+    const TimeCubeLayout &layout = cube->getLayout();
+    int index = layout.findTime(currTime);
+    if(index >= 0 && index + rasterCount < layout.times.size())
+        currTime = layout.times[index + rasterCount].t1;
+    else
+        currTime = std::numeric_limits<double>::max();
+}
+
+double TimeCubeSource::getCurrentTimeEnd(double currTime) const {
+    const TimeCubeLayout &layout = cube->getLayout();
+    int index = layout.findTime(currTime);
+    return index >= 0 ? layout.times[index].t2 : currTime;
+}
+
+Origin TimeCubeSource::getOrigin() const {
+    return cube->getLayout().origin;
+}
+
+Resolution TimeCubeSource::getNativeBlockSize() {
+    return cube->getLayout().tileRes;
+}
+
+bool TimeCubeSource::hasFixedTileResolution() {
+    return true;
+}
+
+std::string TimeCubeSource::getFileIdentity(double time) {
+    return fileIdentity(cubePath);
+}
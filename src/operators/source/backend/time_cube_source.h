@@ -0,0 +1,53 @@
+
+#ifndef RASTER_TIME_SERIES_TIME_CUBE_SOURCE_H
+#define RASTER_TIME_SERIES_TIME_CUBE_SOURCE_H
+
+#include "operators/source/source_operator.h"
+#include "util/time_cube.h"
+
+namespace rts {
+
+    /**
+     * Source operator reading a time cube file, the native storage format created by rts_build_time_cube.
+     * The tiles are not decoded: a tile is copied from the mapped file, see TimeCube.
+     * Only tiles at the edge of the query are changed, their pixels outside of the query are set to nodata.
+     *
+     * The cube stores the tiles of the world tile grid of the query it was created with. It can be read by queries
+     * with the same pixel size and tileRes, the query rectangle and time can be any part of the cube.
+     * Tiles and times outside of the cube are returned filled with nodata.
+     * The file of the dataset is <root>/time_cube/<dataset>.cube, with the root of the DatasetCatalog.
+     */
+    class TimeCubeSource : public SourceBackend {
+    public:
+        TimeCubeSource(const QueryRectangle &qrect, const Json::Value &params);
+        void initialize() override;
+        bool supportsOrder(Order o) const override;
+        OptionalDescriptor createDescriptor(double time, int pixelStartX, int pixelStartY, int tileIndex, const Resolution &rasterWorldPixelStart, const Scale &scale, const Origin &origin, const Resolution &tileCount) override;
+        double getCurrentTimeEnd(double currTime) const override;
+        void increaseCurrentTime(double &currTime) override;
+        void advanceCurrentTime(double &currTime, uint32_t rasterCount) override;
+        Origin getOrigin() const override;
+
+        /**
+         * The tiles of the cube are its blocks.
+         */
+        Resolution getNativeBlockSize() override;
+
+        /**
+         * The tileRes of the query must be the one of the cube.
+         */
+        bool hasFixedTileResolution() override;
+
+        /**
+         * The path and modification time of the cube file, the same for all rasters.
+         */
+        std::string getFileIdentity(double time) override;
+
+    private:
+        std::shared_ptr<const TimeCube> cube;
+        std::string cubePath;
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_TIME_CUBE_SOURCE_H
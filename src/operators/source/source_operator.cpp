@@ -1,23 +1,64 @@
 
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <boost/filesystem.hpp>
 #include "util/raster_calculations.h"
 #include "operators/source/source_operator.h"
 #include "source_operator.h"
 #include "util/benchmark.h"
+#include "util/dataset_catalog.h"
 #include "backend/gdal_source.h"
 #include "backend/fake_source.h"
+#include "backend/time_cube_source.h"
 
 using namespace rts;
 
 SourceOperator::SourceOperator(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in)
-        : GenericOperator(operator_tree, qrect, params, std::move(in)), increaseDimensions(false), pixelStateX(0), pixelStateY(0), currTileIndex(0), currRasterIndex(0)
+        : GenericOperator(operator_tree, qrect, params, std::move(in)), increaseDimensions(false), pixelStateX(0), pixelStateY(0), currTileIndex(0), currRasterIndex(0),
+          samplingToReturn(0), samplingToSkip(0)
 {
+    backend = createBackend(operator_tree, qrect, params);
+}
+
+std::unique_ptr<SourceBackend> SourceOperator::createBackend(const OperatorTree *operatorTree, const QueryRectangle &qrect, const Json::Value &params) {
     const std::string &backendName = params["backend"].asString();
     if(backendName == "gdal_source"){
-        backend = std::make_unique<GDALSource>(qrect, params);
+        return std::make_unique<GDALSource>(operatorTree, qrect, params);
     }
     else if(backendName == "fake_source"){
-        backend = std::make_unique<FakeSource>(qrect, params);
+        return std::make_unique<FakeSource>(qrect, params);
     }
+    else if(backendName == "time_cube"){
+        return std::make_unique<TimeCubeSource>(qrect, params);
+    }
+    return nullptr;
+}
+
+Resolution SourceOperator::autoTileResolution(const OperatorTree *operatorTree, const QueryRectangle &qrect, const Json::Value &params) {
+    std::unique_ptr<SourceBackend> backend = createBackend(operatorTree, qrect, params);
+    if(backend == nullptr)
+        throw std::runtime_error("Source Operator: unknown backend " + params["backend"].asString());
+    backend->initialize();
+    Resolution block = backend->getNativeBlockSize();
+    if(backend->hasFixedTileResolution())
+        return block;
+    if(block.resX == 0 || block.resY == 0)
+        block = Resolution(1, 1);
+
+    //multiples of the block size closest to the target size, strips wider than the target get fewer rows.
+    auto multipleOfBlock = [](uint32_t blockSize, double target) -> uint32_t {
+        return blockSize * static_cast<uint32_t>(std::max(1L, std::lround(target / blockSize)));
+    };
+    uint32_t tileX = multipleOfBlock(block.resX, AUTO_TILE_SIZE);
+    uint32_t tileY = multipleOfBlock(block.resY, static_cast<double>(AUTO_TILE_SIZE) * AUTO_TILE_SIZE / tileX);
+    return Resolution(tileX, tileY);
+}
+
+Resolution SourceOperator::getNativeBlockSize() const {
+    return backend->getNativeBlockSize();
 }
 
 
@@ -33,6 +74,23 @@ void SourceOperator::initialize(){
     rasterWorldPixelStart = tileCountAndPixelStart.second;
 
     setCurrTimeToFirstRaster();
+
+    std::string cacheDirectory = params.get("tile_cache_directory", "").asString();
+    if(!cacheDirectory.empty()){
+        diskCache = DiskTileCache::open(cacheDirectory, params.get("tile_cache_size", 1024 * 1024 * 1024).asUInt64());
+
+        Json::Value sourceParams = params;
+        sourceParams.removeMember("tile_cache_directory");
+        sourceParams.removeMember("tile_cache_size");
+        Json::StreamWriterBuilder writer;
+        writer["indentation"] = "";
+        std::ostringstream key;
+        key.precision(17);
+        key << boost::filesystem::absolute(DatasetCatalog::getRoot()).string() << ";"
+            << Json::writeString(writer, sourceParams) << ";" << qrect.projection.authority << ":" << qrect.projection.code
+            << ";" << qrect.tileRes.resX << "x" << qrect.tileRes.resY << ";" << scale.x << "," << scale.y;
+        diskCacheKeyPrefix = key.str();
+    }
 }
 
 OptionalDescriptor SourceOperator::nextDescriptor() {
@@ -74,7 +132,7 @@ OptionalDescriptor SourceOperator::nextDescriptor() {
         pixelStateY -= rasterWorldPixelStart.resY % qrect.tileRes.resY;
     }
 
-    auto ret = backend->createDescriptor(currTime, pixelStateX, pixelStateY, currTileIndex, rasterWorldPixelStart, scale, origin, tileCount);
+    auto ret = addDiskCache(backend->createDescriptor(currTime, pixelStateX, pixelStateY, currTileIndex, rasterWorldPixelStart, scale, origin, tileCount));
     Benchmark::endSource();
     return ret;
 }
@@ -82,7 +140,22 @@ OptionalDescriptor SourceOperator::nextDescriptor() {
 OptionalDescriptor SourceOperator::getDescriptor(int tileIndex) {
     Benchmark::startSource();
     Resolution pixelStart = tileIndexToStartPixel(tileIndex);
-    auto ret = backend->createDescriptor(currTime, pixelStart.resX, pixelStart.resY, tileIndex, rasterWorldPixelStart, scale, origin, tileCount);
+    auto ret = addDiskCache(backend->createDescriptor(currTime, pixelStart.resX, pixelStart.resY, tileIndex, rasterWorldPixelStart, scale, origin, tileCount));
+    Benchmark::endSource();
+    return ret;
+}
+
+OptionalDescriptorVector SourceOperator::getDescriptors(const std::vector<int> &tileIndices) {
+    Benchmark::startSource();
+    std::vector<Resolution> pixelStarts;
+    pixelStarts.reserve(tileIndices.size());
+    for(int tileIndex : tileIndices){
+        pixelStarts.push_back(tileIndexToStartPixel(tileIndex));
+    }
+    auto ret = backend->createDescriptors(currTime, pixelStarts, tileIndices, rasterWorldPixelStart, scale, origin, tileCount);
+    for(auto &desc : ret){
+        desc = addDiskCache(std::move(desc));
+    }
     Benchmark::endSource();
     return ret;
 }
@@ -92,18 +165,13 @@ Resolution SourceOperator::tileIndexToStartPixel(int tileIndex) {
     if(tileIndex < 0 || tileIndex >= tileCount.resX * tileCount.resY)
         throw std::runtime_error("Invalid Tile index");
 
-    //raster does not start at (0,0) if it does not align with the tiles, see explanation in nextDescriptor()
+    //raster does not start at (0,0) if it does not align with the tiles, see explanation in nextDescriptor().
+    //every row of tiles starts with that offset, like in increaseSpatially().
     Resolution pixelStart;
     pixelStart.resX -= rasterWorldPixelStart.resX % qrect.tileRes.resX;
     pixelStart.resY -= rasterWorldPixelStart.resY % qrect.tileRes.resY;
-
-    for(; tileIndex > 0; --tileIndex){
-        pixelStart.resX += qrect.tileRes.resX;
-        if(pixelStart.resX >= qrect.resX){
-            pixelStart.resX = rasterWorldPixelStart.resX % qrect.tileRes.resX;
-            pixelStart.resY += qrect.tileRes.resY;
-        }
-    }
+    pixelStart.resX += (tileIndex % tileCount.resX) * qrect.tileRes.resX;
+    pixelStart.resY += (tileIndex / tileCount.resX) * qrect.tileRes.resY;
 
     return pixelStart;
 }
@@ -121,8 +189,7 @@ void SourceOperator::skipCurrentRaster(const uint32_t skipCount) {
             currTileIndex = 0;
         }
         //for both orders: advance time to next raster.
-        currRasterIndex += 1;
-        backend->increaseCurrentTime(currTime);
+        advanceRaster();
         increaseDimensions = false;
 
         if (qrect.order == Order::Spatial && currTime >= qrect.t2) {
@@ -163,8 +230,7 @@ void SourceOperator::skipCurrentTile(const uint32_t skipCount) {
             pixelStateX = 0;
             pixelStateY = 0;
             currTileIndex = 0;
-            currRasterIndex += 1;
-            backend->increaseCurrentTime(currTime);
+            advanceRaster();
             rasterEndNotReached = false;
         }
     }
@@ -173,8 +239,7 @@ void SourceOperator::skipCurrentTile(const uint32_t skipCount) {
 bool SourceOperator::increaseTemporally() {
     backend->beforeTemporalIncrease();
     //increasing time means going to next raster.
-    currRasterIndex += 1;
-    backend->increaseCurrentTime(currTime);
+    advanceRaster();
     if(currTime >= qrect.t2 || currTime > backend->datasetEndTime){
         //end of time series or query reached.
         if(qrect.order == Order::Spatial){
@@ -211,6 +276,21 @@ bool SourceOperator::increaseSpatially() {
     return false;
 }
 
+void SourceOperator::advanceRaster() {
+    currRasterIndex += 1;
+    uint32_t rasterSteps = 1;
+    //when sampling, the skipped rasters are jumped over directly, so they are never opened.
+    if(samplingToReturn > 0 && currRasterIndex % samplingToReturn == 0)
+        rasterSteps += samplingToSkip;
+    backend->advanceCurrentTime(currTime, rasterSteps);
+}
+
+bool SourceOperator::pushDownSampling(uint32_t toReturn, uint32_t toSkip) {
+    samplingToReturn = toReturn;
+    samplingToSkip = toSkip;
+    return true;
+}
+
 void SourceOperator::setCurrTimeToFirstRaster() {
     //advance start point for raster, until it is not smaller than t1.
     //if currTime is already bigger than t2, the query will not return any rasters in nextDescriptor() method.
@@ -220,6 +300,43 @@ void SourceOperator::setCurrTimeToFirstRaster() {
     }
 }
 
+OptionalDescriptor SourceOperator::addDiskCache(OptionalDescriptor &&desc) const {
+    if(diskCache == nullptr || !desc)
+        return std::move(desc);
+
+    //the part of the tile inside of the query, pixels outside of it are nodata.
+    SpatialReference extent = desc->tileSpatialInfo;
+    extent.x1 = std::max(extent.x1, qrect.x1);
+    extent.y1 = std::max(extent.y1, qrect.y1);
+    extent.x2 = std::min(extent.x2, qrect.x2);
+    extent.y2 = std::min(extent.y2, qrect.y2);
+    std::ostringstream key;
+    key.precision(17);
+    key << diskCacheKeyPrefix << ";" << backend->getFileIdentity(desc->rasterInfo.t1) << ";" << desc->rasterInfo.t1
+        << ";" << extent.x1 << "," << extent.y1 << "," << extent.x2 << "," << extent.y2;
+
+    DescriptorInfo info(desc);
+    auto getter = [input = std::move(desc), cache = diskCache, key = key.str()](const Descriptor &self) -> UniqueRaster {
+        Benchmark::startSource();
+        UniqueRaster raster = cache->get(key);
+        Benchmark::endSource();
+        if(raster == nullptr){
+            raster = input->getRaster();
+            //the cache is only an optimization, the query continues with the loaded tile when it can not be written.
+            try {
+                cache->put(key, raster.get());
+            } catch(const std::exception &e){
+                static std::once_flag warned;
+                std::call_once(warned, [&e](){
+                    std::cerr << "Source Operator: writing to the tile cache failed, tiles are not cached: " << e.what() << "\n";
+                });
+            }
+        }
+        return raster;
+    };
+    return rts::make_optional<Descriptor>(std::move(getter), info);
+}
+
 bool SourceOperator::supportsOrder(Order order) const {
     return backend->supportsOrder(order);
 }
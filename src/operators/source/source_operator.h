@@ -5,6 +5,7 @@
 #include "operators/generic_operator.h"
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include "backend/source_backend.h"
+#include "util/disk_tile_cache.h"
 
 namespace rts {
 
@@ -13,6 +14,18 @@ namespace rts {
      * nextDescriptor calls.
      * Source operators must implement only the createDescriptor method to return tiles for either nextDescriptor()
      * or getDescriptor() but if needed they can overwrite these methods too.
+     *
+     * With tile_cache_directory the loaded tiles are kept in a DiskTileCache that persists between queries. A tile is
+     * identified by the root of the DatasetCatalog, the source params, the projection, tile and pixel resolution, the
+     * file it is read from with its modification time, the start time of its raster and its extent inside of the query.
+     * Tiles that can not be written to the cache are only returned. So the same tile is found by any query that needs it, even when the query
+     * rectangle differs.
+     *
+     * Parameters:
+     *  - backend: [gdal_source, fake_source, time_cube]
+     *  - tile_cache_directory: optional directory of the persistent tile cache.
+     *  - tile_cache_size: maximum size of the tile cache directory in bytes. Default 1 GiB.
+     *  - max_open_datasets: gdal_source only, maximum number of files kept open by all sources of the query. Default 64.
      */
     class SourceOperator : public GenericOperator {
     public:
@@ -21,7 +34,41 @@ namespace rts {
         bool supportsOrder(Order order) const override;
         OptionalDescriptor nextDescriptor() override;
         OptionalDescriptor getDescriptor(int tileIndex) override;
+        OptionalDescriptorVector getDescriptors(const std::vector<int> &tileIndices) override;
+
+        /**
+         * The source takes over the sampling: after toReturn rasters it advances the time by toSkip more rasters,
+         * so the skipped rasters are never created or opened by the backend.
+         * In spatial order the pattern starts again for every tile, like it does in the Sampler.
+         */
+        bool pushDownSampling(uint32_t toReturn, uint32_t toSkip) override;
+
+        /**
+         * @return The size of the blocks the backend stores the data in, in query pixels, (0,0) when it has no blocks.
+         */
+        Resolution getNativeBlockSize() const;
+
+        /**
+         * Selects the tile resolution for a query rectangle with a tileRes of "auto". The tiles cover whole blocks
+         * of the backend and have about AUTO_TILE_SIZE x AUTO_TILE_SIZE pixels, so no block is decoded for more than
+         * one tile of a raster. Backends without blocks get tiles of exactly that size, backends with a fixed tile
+         * resolution get their block size.
+         * @param operatorTree The tree of the query the source operator belongs to.
+         * @param qrect The query rectangle, its tileRes is not used.
+         * @param params The params of the source operator.
+         */
+        static Resolution autoTileResolution(const OperatorTree *operatorTree, const QueryRectangle &qrect, const Json::Value &params);
+
+        /**
+         * Edge length in pixels of the tiles the auto tile resolution aims for.
+         */
+        static constexpr uint32_t AUTO_TILE_SIZE = 512;
     protected:
+        /**
+         * Creates the backend named by the backend parameter, nullptr for an unknown name.
+         */
+        static std::unique_ptr<SourceBackend> createBackend(const OperatorTree *operatorTree, const QueryRectangle &qrect, const Json::Value &params);
+
         /**
          * Increases the spatial position of the pixelState
          * @return true when increasing the spatial tile went over the end of the current raster.
@@ -51,6 +98,12 @@ namespace rts {
          */
         void skipCurrentTile(const uint32_t skipCount) override;
 
+        /**
+         * Advances currTime to the start of the next raster that is returned and increases currRasterIndex.
+         * Rasters skipped by sampling are jumped over here.
+         */
+        void advanceRaster();
+
         /**
          * Calculates the pixel start position of a tile based on its index.
          * Will be used when getDescriptor(int index) is implemented.
@@ -105,13 +158,32 @@ namespace rts {
          * The coordinate origin of the source raster.
          */
         Origin origin;
+        /**
+         * Number of rasters returned before skipping when the sampling is pushed down, 0 for no sampling.
+         */
+        uint32_t samplingToReturn;
+        /**
+         * Number of rasters skipped after samplingToReturn returned rasters.
+         */
+        uint32_t samplingToSkip;
 
         /**
          * Sets internal currTime variable to the start of the first raster that is part of the query.
          */
         void setCurrTimeToFirstRaster();
 
+        /**
+         * Replaces the getter of the descriptor with one that reads the tile from the disk tile cache when it is
+         * cached, else loads the tile from the backend and writes it to the cache.
+         */
+        OptionalDescriptor addDiskCache(OptionalDescriptor &&desc) const;
+
         std::unique_ptr<SourceBackend> backend;
+        std::shared_ptr<DiskTileCache> diskCache;
+        /**
+         * Part of the disk cache key that is the same for all tiles of this operator.
+         */
+        std::string diskCacheKeyPrefix;
     };
 
 }
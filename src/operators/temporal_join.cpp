@@ -0,0 +1,235 @@
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include "util/parsing.h"
+#include "operators/temporal_join.h"
+
+using namespace rts;
+
+/**
+ * A cached input tile that can be part of several outputs. Its raster is loaded once, when the first output needs it,
+ * and every output gets a copy of it.
+ */
+struct SharedTile {
+    explicit SharedTile(Descriptor &&descriptor) : descriptor(std::move(descriptor)) { }
+
+    UniqueRaster copyRaster() {
+        std::call_once(loaded, [this](){
+            raster = descriptor.getRaster();
+        });
+        UniqueRaster copy = Raster::createRaster(raster->getDataType(), raster->getResolution());
+        std::memcpy(copy->getVoidDataPointer(), raster->getVoidDataPointer(), static_cast<size_t>(raster->getDataLength()) * raster->sizeOfDataType());
+        return copy;
+    }
+
+    Descriptor descriptor;
+    UniqueRaster raster;
+    std::once_flag loaded;
+};
+
+TemporalJoin::TemporalJoin(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in)
+        : GenericOperator(operator_tree, qrect, params, std::move(in)),
+          nextTileIndex(0), tileCount(0), customDataType(GDT_Unknown)
+{
+    if(input_operators.size() < 2)
+        throw std::runtime_error("TemporalJoin: at least two input operators are needed.");
+    joinInputs.resize(input_operators.size());
+}
+
+void TemporalJoin::initialize() {
+    formula = std::make_unique<RasterFormula>(params["expression"].asString());
+    if(formula->getInputCount() > input_operators.size())
+        throw std::runtime_error("TemporalJoin: the expression uses more rasters than there are input operators.");
+    customDataType = params.isMember("custom_data_type") ? Parsing::parseDataType(params["custom_data_type"].asString()) : GDT_Unknown;
+}
+
+bool TemporalJoin::supportsOrder(Order order) const {
+    return order == Order::Temporal;
+}
+
+OptionalDescriptor TemporalJoin::nextDescriptor() {
+    OptionalDescriptorVector tiles;
+    if(!nextInputTiles(tiles))
+        return boost::none;
+    return createOutput(std::move(tiles), rasterResultTime);
+}
+
+OptionalDescriptor TemporalJoin::getDescriptor(int tileIndex) {
+    OptionalDescriptorVector tiles;
+    tiles.reserve(input_operators.size());
+    TemporalReference resultTime;
+    for(size_t i = 0; i < input_operators.size(); ++i){
+        auto tile = input_operators[i]->getDescriptor(tileIndex);
+        if(!tile)
+            return boost::none;
+        resultTime = i == 0 ? static_cast<TemporalReference>(tile->rasterInfo) : resultTime.getOverlapTemporal(tile->rasterInfo);
+        tiles.emplace_back(std::move(tile));
+    }
+    return createOutput(std::move(tiles), resultTime);
+}
+
+bool TemporalJoin::nextInputTiles(OptionalDescriptorVector &tiles) {
+    if(nextTileIndex == 0 && !startRaster())
+        return false;
+
+    tiles.clear();
+    tiles.reserve(joinInputs.size());
+    for(size_t i = 0; i < joinInputs.size(); ++i){
+        tiles.emplace_back(nextInputTile(i));
+        if(!tiles.back())
+            return false;
+    }
+
+    nextTileIndex = (nextTileIndex + 1) % tileCount;
+    return true;
+}
+
+bool TemporalJoin::startRaster() {
+    //a raster that was cached completely for the last output raster is read from the cache, else from the input operator.
+    for(size_t i = 0; i < joinInputs.size(); ++i){
+        auto &in = joinInputs[i];
+        in.fromCache = !in.cache.empty();
+        if(in.fromCache){
+            in.time = in.cache.front()->rasterInfo;
+        } else {
+            in.firstTile = input_operators[i]->nextDescriptor();
+            if(!in.firstTile)
+                return false;
+            in.time = in.firstTile->rasterInfo;
+        }
+    }
+
+    //the input whose raster ends first can not overlap with the others when the latest start is not before its end.
+    while(true){
+        size_t endsFirst = 0;
+        double latestStart = joinInputs[0].time.t1;
+        for(size_t i = 1; i < joinInputs.size(); ++i){
+            if(joinInputs[i].time.t2 < joinInputs[endsFirst].time.t2)
+                endsFirst = i;
+            latestStart = std::max(latestStart, joinInputs[i].time.t1);
+        }
+        if(latestStart < joinInputs[endsFirst].time.t2){
+            rasterResultTime = TemporalReference(latestStart, joinInputs[endsFirst].time.t2);
+            break;
+        }
+
+        auto &in = joinInputs[endsFirst];
+        if(in.fromCache){
+            in.cache.clear();
+            in.fromCache = false;
+        } else {
+            //only the first tile of the raster was read, the other tiles are not created at all.
+            input_operators[endsFirst]->skipCurrentRaster();
+        }
+        in.firstTile = input_operators[endsFirst]->nextDescriptor();
+        if(!in.firstTile)
+            return false;
+        in.time = in.firstTile->rasterInfo;
+    }
+
+    auto &first = joinInputs[0].fromCache ? joinInputs[0].cache.front() : joinInputs[0].firstTile;
+    tileCount = first->rasterTileCount;
+
+    //a raster that lasts longer than the current interval overlaps with the next interval too.
+    for(auto &in : joinInputs){
+        in.neededAgain = in.time.t2 > rasterResultTime.t2;
+        if(in.neededAgain && !in.fromCache)
+            in.cache.set_capacity(tileCount);
+    }
+    return true;
+}
+
+OptionalDescriptor TemporalJoin::nextInputTile(size_t input) {
+    auto &in = joinInputs[input];
+    OptionalDescriptor desc = boost::none;
+    if(in.fromCache){
+        desc = std::move(in.cache.front());
+        in.cache.pop_front();
+    } else if(in.firstTile) {
+        desc = std::move(in.firstTile);
+        in.firstTile = boost::none;
+    } else {
+        desc = input_operators[input]->nextDescriptor();
+        if(!desc)
+            return boost::none;
+    }
+
+    //descriptors from the cache are already shared, copying them only copies the shared getter.
+    if(in.neededAgain){
+        if(!in.fromCache)
+            desc = makeShared(std::move(desc));
+        in.cache.push_back(desc);
+    }
+    return desc;
+}
+
+void TemporalJoin::finishRaster() {
+    for(size_t i = 0; i < joinInputs.size(); ++i){
+        auto &in = joinInputs[i];
+        if(in.fromCache || in.neededAgain){
+            //the cache has to contain the complete raster, creating the descriptors does not load the tiles.
+            for(uint32_t tile = nextTileIndex; tile < tileCount; ++tile){
+                if(!nextInputTile(i))
+                    break;
+            }
+        } else {
+            input_operators[i]->skipCurrentRaster();
+            in.firstTile = boost::none;
+        }
+    }
+    nextTileIndex = 0;
+}
+
+void TemporalJoin::skipCurrentRaster(const uint32_t skipCount) {
+    for(uint32_t i = 0; i < skipCount; ++i){
+        //when the last tile of a raster was returned, the current raster is already finished.
+        if(nextTileIndex == 0){
+            if(i == 0)
+                continue;
+            if(!startRaster())
+                return;
+        }
+        finishRaster();
+    }
+}
+
+void TemporalJoin::skipCurrentTile(const uint32_t skipCount) {
+    OptionalDescriptorVector tiles;
+    for(uint32_t i = 0; i < skipCount; ++i){
+        if(!nextInputTiles(tiles))
+            return;
+    }
+}
+
+OptionalDescriptor TemporalJoin::makeShared(OptionalDescriptor &&desc) {
+    DescriptorInfo descInfo(desc);
+    auto shared = std::make_shared<SharedTile>(std::move(*desc));
+    auto getter = [shared](const Descriptor &self) -> UniqueRaster {
+        return shared->copyRaster();
+    };
+    return rts::make_optional<Descriptor>(std::move(getter), descInfo);
+}
+
+OptionalDescriptor TemporalJoin::createOutput(OptionalDescriptorVector &&inputs, const TemporalReference &rasterResultTime) {
+    DescriptorInfo descInfo(inputs[0]);
+    descInfo.rasterInfo = SpatialTemporalReference(rasterResultTime, inputs[0]->rasterInfo, inputs[0]->rasterInfo);
+    if(customDataType != GDT_Unknown)
+        descInfo.dataType = customDataType;
+
+    auto getter = [inputs = std::move(inputs), formula = formula.get()](const Descriptor &self) -> UniqueRaster {
+        //inputs that are not part of the formula are not loaded.
+        std::vector<UniqueRaster> rasters(inputs.size());
+        std::vector<double> nodata(inputs.size());
+        for(uint32_t i = 0; i < inputs.size(); ++i){
+            nodata[i] = inputs[i]->nodata;
+            if(formula->usesInput(i))
+                rasters[i] = inputs[i]->getRaster();
+        }
+        UniqueRaster output = Raster::createRaster(self.dataType, self.tileResolution);
+        formula->evaluate(rasters, nodata, output.get(), self.nodata);
+        return output;
+    };
+
+    return rts::make_optional<Descriptor>(std::move(getter), descInfo);
+}
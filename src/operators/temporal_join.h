@@ -0,0 +1,97 @@
+
+#ifndef RASTER_TIME_SERIES_TEMPORAL_JOIN_H
+#define RASTER_TIME_SERIES_TEMPORAL_JOIN_H
+
+#include <boost/circular_buffer.hpp>
+#include "operators/generic_operator.h"
+#include "util/raster_formula.h"
+
+namespace rts {
+
+    /**
+     * Joins any number of time series with different cadences, e.g. daily, 8-day and monthly products.
+     * An output raster is returned for every interval in which the current rasters of all inputs overlap, it is valid
+     * for exactly that interval. Then the inputs whose raster ends with the interval advance to their next raster.
+     * The output is calculated with a RasterFormula that sees the tiles of all inputs.
+     *
+     * Rasters that last longer than the current interval overlap with the next interval, too. Only the tiles of those
+     * rasters are kept in a ring buffer per input, the descriptors are moved into the buffer and share their getter
+     * with the outputs. The raster of a cached tile is loaded once, when the first output needs it, and copied for
+     * every output, so the input is not loaded twice.
+     * Rasters that do not overlap with all other inputs are skipped with skipCurrentRaster on the input,
+     * so only the descriptor of their first tile is created.
+     *
+     * Only supports temporal order.
+     *
+     * Params:
+     *  - expression: String defining a formula for the RasterFormula class, e.g. "(A + B) * C". A is the first input.
+     *  - custom_data_type: [Byte, UInt16, Int16, UInt32, Int32, Float32, Float64], when not provided data type of the first input is used.
+     *
+     */
+    class TemporalJoin : public GenericOperator {
+    public:
+        TemporalJoin(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in);
+        OptionalDescriptor nextDescriptor() override;
+        OptionalDescriptor getDescriptor(int tileIndex) override;
+        void initialize() override;
+        bool supportsOrder(Order order) const override;
+        void skipCurrentRaster(uint32_t skipCount = 1) override;
+        void skipCurrentTile(uint32_t skipCount = 1) override;
+    protected:
+        /**
+         * Creates the output descriptor for the joined tiles of all inputs.
+         * @param inputs The tiles of all inputs with the same tile index.
+         * @param rasterResultTime The interval in which the rasters of all inputs overlap.
+         */
+        virtual OptionalDescriptor createOutput(OptionalDescriptorVector &&inputs, const TemporalReference &rasterResultTime);
+    private:
+        /**
+         * State of one of the inputs for the current output raster.
+         */
+        struct JoinInput {
+            TemporalReference time;
+            boost::circular_buffer<OptionalDescriptor> cache;
+            OptionalDescriptor firstTile;
+            bool fromCache = false;
+            bool neededAgain = false;
+        };
+
+        /**
+         * Moves all inputs to the next rasters that overlap temporally.
+         * @return false, if one of the inputs has no more rasters.
+         */
+        bool startRaster();
+
+        /**
+         * @return The next tile of the input, either from the cache or from the input operator.
+         */
+        OptionalDescriptor nextInputTile(size_t input);
+
+        /**
+         * Sets the next tiles of all inputs that are joined to an output tile.
+         * @return false, if one of the inputs has no more tiles.
+         */
+        bool nextInputTiles(OptionalDescriptorVector &tiles);
+
+        /**
+         * Skips the remaining tiles of the current output raster in all inputs.
+         */
+        void finishRaster();
+
+        /**
+         * @return A descriptor that can be copied cheaply, sharing the getter of the passed descriptor. The raster is
+         *         only loaded on the first call of the getter, all calls return a copy of it.
+         */
+        static OptionalDescriptor makeShared(OptionalDescriptor &&desc);
+
+        std::vector<JoinInput> joinInputs;
+        TemporalReference rasterResultTime;
+        uint32_t nextTileIndex;
+        uint32_t tileCount;
+        std::unique_ptr<RasterFormula> formula;
+        GDALDataType customDataType;
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_TEMPORAL_JOIN_H
@@ -2,7 +2,7 @@
 #ifndef RASTER_TIME_SERIES_TEMPORAL_OVERLAP_H
 #define RASTER_TIME_SERIES_TEMPORAL_OVERLAP_H
 
-#include "operators/generic_operator.h"
+#include "operators/temporal_join.h"
 #include "util/expression.h"
 
 namespace rts {
@@ -11,27 +11,20 @@ namespace rts {
      * Takes two time series as inputs and returns rasters for times where rasters of both time series overlap.
      * The returned raster is defined by an expression.
      *
+     * The joining of the rasters is done by TemporalJoin, this operator only calculates the output with
+     * the Expression class.
+     *
      * Params:
      *  - expression: String defining a valid expression for the Expression class.
      *
      */
-    class TemporalOverlap : public GenericOperator {
+    class TemporalOverlap : public TemporalJoin {
     public:
         TemporalOverlap(const OperatorTree *operator_tree, const QueryRectangle &qrect, const Json::Value &params, std::vector<std::unique_ptr<GenericOperator>> &&in);
-        OptionalDescriptor nextDescriptor() override;
-        OptionalDescriptor getDescriptor(int tileIndex) override;
         void initialize() override;
-        bool supportsOrder(Order order) const override;
+    protected:
+        OptionalDescriptor createOutput(OptionalDescriptorVector &&inputs, const TemporalReference &rasterResultTime) override;
     private:
-        OptionalDescriptor createOutput(OptionalDescriptor &inputA, OptionalDescriptor &inputB, TemporalReference &rasterResultTime);
-        TemporalReference input1Time;
-        TemporalReference input2Time;
-        std::vector<OptionalDescriptor> descriptorCache1;
-        std::vector<OptionalDescriptor> descriptorCache2;
-        bool lastTileOfRaster1;
-        bool lastTileOfRaster2;
-        bool loadRasterFromCache1;
-        bool loadRasterFromCache2;
         Expression expression;
     };
 
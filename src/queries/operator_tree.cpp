@@ -4,6 +4,7 @@
 #include "operators/cumulative_sum.h"
 #include "operators/consuming/print.h"
 #include "operators/consuming/geotiff_export.h"
+#include "operators/consuming/array_export.h"
 #include "operators/consuming/raster_value_extraction.h"
 #include "operators/consuming/analyzer.h"
 #include "operators/expression_operator.h"
@@ -13,18 +14,46 @@
 #include "operators/convolution.h"
 #include "operators/order_changer.h"
 #include "operators/raster_cache.h"
+#include "operators/rolling_aggregator.h"
+#include "operators/temporal_join.h"
+#include "util/gdal_dataset_pool.h"
 
 using namespace rts;
 
 OperatorTree::OperatorTree(const Json::Value &query)
-        : operator_name(query["operator"].asString()), params(query["params"]), qrect(query["query_rectangle"]), isConsuming(true)
+        : operator_name(query["operator"].asString()), params(query["params"]), qrect(query["query_rectangle"]), isConsuming(true), root(this)
 {
+    resolveAutoTileRes(query);
     createChildren(query["sources"]);
+    setRootRecursively(this);
+}
+
+void OperatorTree::resolveAutoTileRes(const Json::Value &query) {
+    if(!qrect.hasAutoTileRes())
+        return;
+    const Json::Value *source = findSource(query);
+    if(source == nullptr)
+        throw std::runtime_error("tileRes auto needs a source operator in the query.");
+    qrect.tileRes = SourceOperator::autoTileResolution(this, qrect, (*source)["params"]);
+}
+
+const Json::Value* OperatorTree::findSource(const Json::Value &query) {
+    if(query["operator"].asString() == "source")
+        return &query;
+    const Json::Value &sources = query["sources"];
+    for(int i = 0; i < sources.size(); ++i){
+        const Json::Value *source = findSource(sources[i]);
+        if(source != nullptr)
+            return source;
+    }
+    return nullptr;
 }
 
 OperatorTree::OperatorTree(const Json::Value &query, QueryRectangle &qrect)
-        : operator_name(query["operator"].asString()), params(query["params"]), qrect(qrect), isConsuming(false)
+        : operator_name(query["operator"].asString()), params(query["params"]), qrect(qrect), isConsuming(false), root(this)
 {
+    //only does something for sub trees that are created directly from a parsed query rectangle, e.g. by the tools.
+    resolveAutoTileRes(query);
     createChildren(query["sources"]);
 }
 
@@ -35,6 +64,13 @@ void OperatorTree::createChildren(const Json::Value &sourcesJson){
     }
 }
 
+void OperatorTree::setRootRecursively(const OperatorTree *root) {
+    this->root = root;
+    for(auto *child : children){
+        child->setRootRecursively(root);
+    }
+}
+
 OperatorTree::~OperatorTree() {
     for(auto *child : children){
         delete child;
@@ -62,18 +98,43 @@ std::unique_ptr<GenericOperator> OperatorTree::instantiate() const {
         res = std::make_unique<CumulativeSum>(this, qrect, params, std::move(sources));
     else if(operator_name == "temporal_overlap")
         res = std::make_unique<TemporalOverlap>(this, qrect, params, std::move(sources));
+    else if(operator_name == "temporal_join")
+        res = std::make_unique<TemporalJoin>(this, qrect, params, std::move(sources));
     else if(operator_name == "convolution")
         res = std::make_unique<Convolution>(this, qrect, params, std::move(sources));
     else if(operator_name == "order_changer")
         res = std::make_unique<OrderChanger>(this, qrect, params, std::move(sources));
     else if(operator_name == "raster_cache")
         res = std::make_unique<RasterCache>(this, qrect, params, std::move(sources));
+    else if(operator_name == "rolling_aggregator")
+        res = std::make_unique<RollingAggregator>(this, qrect, params, std::move(sources));
     else
         throw std::runtime_error("Unknown operator: " + operator_name);
 
     return res;
 }
 
+std::shared_ptr<TileCache> OperatorTree::getTileCache(size_t byteBudget, bool compress) const {
+    std::lock_guard<std::mutex> lock(tileCacheMutex);
+    if(tileCache == nullptr)
+        tileCache = std::make_shared<TileCache>(byteBudget, compress);
+    return tileCache;
+}
+
+bool OperatorTree::hasTileCache() const {
+    std::lock_guard<std::mutex> lock(tileCacheMutex);
+    return tileCache != nullptr;
+}
+
+std::shared_ptr<GdalDatasetPool> OperatorTree::getDatasetPool(size_t maxOpen) const {
+    if(root != this)
+        return root->getDatasetPool(maxOpen);
+    std::lock_guard<std::mutex> lock(datasetPoolMutex);
+    if(datasetPool == nullptr)
+        datasetPool = std::make_shared<GdalDatasetPool>(maxOpen);
+    return datasetPool;
+}
+
 std::unique_ptr<ConsumingOperator> OperatorTree::instantiateConsuming() const {
 
     if(!isConsuming)
@@ -90,6 +151,8 @@ std::unique_ptr<ConsumingOperator> OperatorTree::instantiateConsuming() const {
         res = std::make_unique<Print>(this, qrect, params, std::move(sources));
     else if(operator_name == "geotiff_export")
         res = std::make_unique<GeotiffExport>(this, qrect, params, std::move(sources));
+    else if(operator_name == "array_export")
+        res = std::make_unique<ArrayExport>(this, qrect, params, std::move(sources));
     else if(operator_name == "raster_value_extraction")
         res =  std::make_unique<RasterValueExtraction>(this, qrect, params, std::move(sources));
     else if(operator_name == "analyzer")
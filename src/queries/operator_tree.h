@@ -5,13 +5,16 @@
 #include <vector>
 #include <memory>
 #include <string>
+#include <mutex>
 #include <json/json.h>
 #include "operators/generic_operator.h"
+#include "util/tile_cache.h"
 
 namespace rts {
 
     class GenericOperator;
     class ConsumingOperator;
+    class GdalDatasetPool;
 
     /**
      * An OperatorTree is the logical view on the operators of an query. It is used to instantiate an actual
@@ -23,12 +26,14 @@ namespace rts {
 
         /**
          * Constructor for creating the top of an operator tree, so it is a consuming operator.
+         * A tileRes of "auto" is selected here from the block layout of the first source operator of the query.
          * @param query The full query json, including the query rectangle definition.
          */
         explicit OperatorTree(const Json::Value &query);
 
         /**
          * Constructor for creating a sub operator tree, by passing the qrect already parsed by the consuming operator.
+         * A tileRes of "auto" is resolved with the first source operator of the sub tree.
          * @param query Json query of this sub operator.
          * @param qrect Query Rectangle of the full query.
          */
@@ -53,18 +58,59 @@ namespace rts {
          */
         std::unique_ptr<ConsumingOperator> instantiateConsuming() const;
 
+        /**
+         * Tile cache of this operator, shared by all its instances. So operators that are re-instantiated for random
+         * access, e.g. by the aggregator, find the tiles loaded by the other instances.
+         * @param byteBudget The budget of the cache, only used by the first call that creates the cache.
+         * @param compress If the cache stores the tiles encoded, only used by the first call that creates the cache.
+         */
+        std::shared_ptr<TileCache> getTileCache(size_t byteBudget, bool compress = false) const;
+
+        /**
+         * @return If getTileCache() was already called.
+         */
+        bool hasTileCache() const;
+
+        /**
+         * Pool of open GDAL datasets, shared by all operators of the query, so all source operators and their
+         * re-instantiated copies reuse the opened files.
+         * @param maxOpen The maximum number of open datasets, only used by the first call that creates the pool.
+         */
+        std::shared_ptr<GdalDatasetPool> getDatasetPool(size_t maxOpen) const;
+
     private:
         std::string operator_name;
         bool isConsuming;
         QueryRectangle qrect;
         Json::Value params;
         std::vector<OperatorTree*> children;
+        mutable std::shared_ptr<TileCache> tileCache;
+        mutable std::mutex tileCacheMutex;
+        const OperatorTree *root;
+        mutable std::shared_ptr<GdalDatasetPool> datasetPool;
+        mutable std::mutex datasetPoolMutex;
 
         /**
          * Instantiates all the children/input operators of this operator and inserts them into the children vector.
          * @param sourcesJson Json array defining all child/input operators of this operator.
          */
         void createChildren(const Json::Value &sourcesJson);
+
+        /**
+         * Sets the root of the whole query tree to this tree and all its children.
+         */
+        void setRootRecursively(const OperatorTree *root);
+
+        /**
+         * Replaces a tileRes of "auto" in the qrect with the tile resolution selected for the first source operator
+         * of the query json. Throws a std::runtime_error when the query has no source operator.
+         */
+        void resolveAutoTileRes(const Json::Value &query);
+
+        /**
+         * @return The first source operator in the query json, depth first, or nullptr if there is none.
+         */
+        static const Json::Value* findSource(const Json::Value &query);
     };
 
 }
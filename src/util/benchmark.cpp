@@ -7,10 +7,11 @@ using namespace std::chrono;
 //init static members
 std::ofstream* Benchmark::outputFile = nullptr;
 high_resolution_clock::time_point Benchmark::queryStart;
-high_resolution_clock::time_point Benchmark::sourceStart;
-high_resolution_clock::time_point Benchmark::consumingStart;
+thread_local high_resolution_clock::time_point Benchmark::sourceStart;
+thread_local high_resolution_clock::time_point Benchmark::consumingStart;
 milliseconds Benchmark::sourceDuration(0);
 milliseconds Benchmark::consumingDuration(0);
+std::mutex Benchmark::durationMutex;
 
 void Benchmark::setFileOutputStream(std::ofstream &outputFile) {
     Benchmark::outputFile = &outputFile;
@@ -35,6 +36,7 @@ void Benchmark::startQuery() {
 
 void Benchmark::endSource() {
     auto now = high_resolution_clock::now();
+    std::lock_guard<std::mutex> lock(durationMutex);
     sourceDuration += duration_cast<milliseconds>(now - sourceStart);
 }
 
@@ -44,6 +46,7 @@ void Benchmark::startConsuming() {
 
 void Benchmark::endConsuming() {
     auto now = high_resolution_clock::now();
+    std::lock_guard<std::mutex> lock(durationMutex);
     consumingDuration += duration_cast<milliseconds>( now - consumingStart );
 }
 
@@ -4,6 +4,7 @@
 
 #include <fstream>
 #include <chrono>
+#include <mutex>
 
 namespace rts {
 
@@ -17,6 +18,8 @@ namespace rts {
      * endQuery() will write three lines into the output file. First line is the milliseconds spend in the source
      * operator, second line is ms spend in consuming operator, and the third line is the total time spend in the query.
      * The last number includes the time spend in source and consuming operator.
+     * Source and consuming time can be measured from multiple threads at the same time (e.g. an aggregator loading rasters
+     * in parallel), then the durations of all threads are summed up.
      */
     class Benchmark {
     public:
@@ -30,10 +33,11 @@ namespace rts {
     private:
         static std::ofstream *outputFile;
         static std::chrono::high_resolution_clock::time_point queryStart;
-        static std::chrono::high_resolution_clock::time_point sourceStart;
-        static std::chrono::high_resolution_clock::time_point consumingStart;
+        static thread_local std::chrono::high_resolution_clock::time_point sourceStart;
+        static thread_local std::chrono::high_resolution_clock::time_point consumingStart;
         static std::chrono::milliseconds sourceDuration;
         static std::chrono::milliseconds consumingDuration;
+        static std::mutex durationMutex;
 
     };
 
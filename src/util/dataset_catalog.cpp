@@ -0,0 +1,116 @@
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <boost/filesystem.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include "util/dataset_catalog.h"
+#include "util/gdal_util.h"
+#include "util/time_interval.h"
+
+using namespace rts;
+using namespace boost::posix_time;
+
+static std::string defaultRoot() {
+    const char *env = std::getenv("RTS_DATA_ROOT");
+    return env != nullptr ? env : "../../test/data";
+}
+
+std::mutex DatasetCatalog::mutex;
+std::string DatasetCatalog::root = defaultRoot();
+std::map<std::string, std::shared_ptr<const CatalogDataset>> DatasetCatalog::datasets;
+
+int CatalogDataset::findFile(double time) const {
+    auto it = std::lower_bound(files.begin(), files.end(), time, [](const DatasetFile &file, double t){
+        return file.timeStart < t;
+    });
+    if(it == files.end() || it->timeStart != time)
+        return -1;
+    return static_cast<int>(it - files.begin());
+}
+
+void DatasetCatalog::setRoot(const std::string &newRoot) {
+    std::lock_guard<std::mutex> lock(mutex);
+    root = newRoot;
+    datasets.clear();
+}
+
+std::string DatasetCatalog::getRoot() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return root;
+}
+
+std::shared_ptr<const CatalogDataset> DatasetCatalog::getGdalSourceDataset(const std::string &name) {
+    return getDataset("gdal_source", name);
+}
+
+std::shared_ptr<const CatalogDataset> DatasetCatalog::getFakeSourceDataset(const std::string &name) {
+    return getDataset("fake_source", name);
+}
+
+std::shared_ptr<const CatalogDataset> DatasetCatalog::getDataset(const std::string &directory, const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    boost::filesystem::path p(root);
+    p /= directory;
+    p /= name + ".json";
+    auto it = datasets.find(p.string());
+    if(it != datasets.end())
+        return it->second;
+
+    auto dataset = std::make_shared<CatalogDataset>(loadDataset(p.string()));
+    if(directory == "gdal_source"){
+        //a relative path of the files is relative to the root, not to the working directory.
+        boost::filesystem::path filesPath(dataset->json["path"].asString());
+        if(filesPath.is_relative())
+            dataset->json["path"] = (boost::filesystem::path(root) / filesPath).string();
+        createFileIndex(*dataset);
+    }
+    datasets.emplace(p.string(), dataset);
+    return dataset;
+}
+
+CatalogDataset DatasetCatalog::loadDataset(const std::string &file) {
+    std::ifstream file_in(file);
+    if(!file_in)
+        throw std::runtime_error("Dataset file could not be opened: " + file);
+    CatalogDataset dataset;
+    try {
+        file_in >> dataset.json;
+    } catch(const std::exception &e){
+        throw std::runtime_error("Dataset file could not be parsed: " + file + ": " + e.what());
+    }
+    return dataset;
+}
+
+void DatasetCatalog::createFileIndex(CatalogDataset &dataset) {
+    const Json::Value &json = dataset.json;
+    TimeInterval timeInterval(json["time_interval"]);
+    if(timeInterval.length == 0)
+        throw std::runtime_error("Dataset has a time interval of length 0: " + json["name"].asString());
+
+    ptime time = time_from_string(json["time_start"].asString());
+    ptime end = time_from_string(json["time_end"].asString());
+    while(time <= end){
+        DatasetFile file;
+        file.timeStart = static_cast<double>(to_time_t(time));
+        timeInterval.increase(time);
+        file.timeEnd = static_cast<double>(to_time_t(time));
+        file.path = gdalFilePath(json, file.timeStart);
+        dataset.files.push_back(std::move(file));
+    }
+}
+
+std::string DatasetCatalog::gdalFilePath(const Json::Value &datasetJson, double time) {
+    std::string timeString = GDALUtil::timeToString((time_t)time, datasetJson["time_format"].asString());
+
+    std::string placeholder = "%%%TIME_STRING%%%";
+    std::string fileName = datasetJson["filename"].asString();
+    size_t placeholderPos = fileName.find(placeholder);
+    if(placeholderPos != std::string::npos)
+        fileName.replace(placeholderPos, placeholder.length(), timeString);
+
+    boost::filesystem::path filePath(datasetJson["path"].asString());
+    filePath /= fileName;
+    return filePath.string();
+}
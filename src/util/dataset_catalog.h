@@ -0,0 +1,84 @@
+
+#ifndef RASTER_TIME_SERIES_DATASET_CATALOG_H
+#define RASTER_TIME_SERIES_DATASET_CATALOG_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <json/json.h>
+
+namespace rts {
+
+    /**
+     * A file of a GDAL source dataset and the time it is valid for.
+     */
+    struct DatasetFile {
+        double timeStart;
+        double timeEnd;
+        std::string path;
+    };
+
+    /**
+     * A dataset loaded by the DatasetCatalog. It is shared by all sources using the dataset and must not be changed.
+     */
+    struct CatalogDataset {
+        Json::Value json;
+
+        /**
+         * The files of a GDAL source dataset from time_start to time_end, sorted by time. Empty for fake source datasets.
+         */
+        std::vector<DatasetFile> files;
+
+        /**
+         * @return Index of the file starting exactly at the time, -1 when there is none.
+         */
+        int findFile(double time) const;
+    };
+
+    /**
+     * Process wide catalog of the dataset files of the sources. Every dataset file is parsed only once, re-instantiated
+     * sources find it in the catalog. For GDAL source datasets the paths of all files are calculated once, too.
+     *
+     * The dataset files are loaded from <root>/gdal_source and <root>/fake_source. The root is ../../test/data
+     * relative to the working directory by default, or the environment variable RTS_DATA_ROOT when it is set.
+     * A relative path of the files inside a GDAL source dataset file is relative to the root.
+     * All methods are thread safe.
+     */
+    class DatasetCatalog {
+    public:
+        /**
+         * Sets the directory the dataset files are loaded from. Datasets that are already loaded are forgotten.
+         */
+        static void setRoot(const std::string &root);
+        static std::string getRoot();
+
+        /**
+         * Throws a std::runtime_error when the dataset file can not be opened or parsed.
+         */
+        static std::shared_ptr<const CatalogDataset> getGdalSourceDataset(const std::string &name);
+
+        /**
+         * Throws a std::runtime_error when the dataset file can not be opened or parsed.
+         */
+        static std::shared_ptr<const CatalogDataset> getFakeSourceDataset(const std::string &name);
+
+        /**
+         * @return The path of the file of a GDAL source dataset for the time, built from filename and time_format.
+         */
+        static std::string gdalFilePath(const Json::Value &datasetJson, double time);
+
+    private:
+        static std::shared_ptr<const CatalogDataset> getDataset(const std::string &directory, const std::string &name);
+        static CatalogDataset loadDataset(const std::string &file);
+        static void createFileIndex(CatalogDataset &dataset);
+
+        static std::mutex mutex;
+        static std::string root;
+        static std::map<std::string, std::shared_ptr<const CatalogDataset>> datasets;
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_DATASET_CATALOG_H
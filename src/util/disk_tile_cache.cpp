@@ -0,0 +1,209 @@
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include "util/disk_tile_cache.h"
+#include "util/mapped_file.h"
+
+using namespace rts;
+
+namespace {
+
+    const char tileFileMagic[8] = {'R', 'T', 'S', 'T', 'I', 'L', 'E', '1'};
+    const std::string tileFileExtension = ".tile";
+
+    /**
+     * FNV-1a hash, unlike std::hash it is the same for every build, which is needed for the persistent file names.
+     */
+    uint64_t stableHash(const std::string &str) {
+        uint64_t hash = 14695981039346656037ULL;
+        for(unsigned char c : str){
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    template<class T>
+    void readValue(const char *&pos, T &value) {
+        std::memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+    }
+
+    template<class T>
+    void writeValue(std::ofstream &file, const T &value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+}
+
+std::shared_ptr<DiskTileCache> DiskTileCache::open(const std::string &directory, uint64_t byteBudget) {
+    static std::mutex openMutex;
+    static std::map<std::string, std::weak_ptr<DiskTileCache>> openCaches;
+
+    std::lock_guard<std::mutex> lock(openMutex);
+    std::string path = boost::filesystem::absolute(directory).string();
+    auto cache = openCaches[path].lock();
+    if(cache == nullptr){
+        cache = std::make_shared<DiskTileCache>(path, byteBudget);
+        openCaches[path] = cache;
+    }
+    return cache;
+}
+
+DiskTileCache::DiskTileCache(const std::string &directory, uint64_t byteBudget)
+        : directory(directory), byteBudget(byteBudget), byteSize(0), hits(0), misses(0)
+{
+    if(!boost::filesystem::exists(directory))
+        boost::filesystem::create_directories(directory);
+
+    //the tiles written by earlier queries count towards the budget.
+    for(auto &entry : boost::filesystem::directory_iterator(directory)){
+        if(!boost::filesystem::is_regular_file(entry.status()) || entry.path().extension() != tileFileExtension)
+            continue;
+        std::string name = entry.path().filename().string();
+        FileInfo &info = files[name];
+        info.size = boost::filesystem::file_size(entry.path());
+        info.usage = usageOrder.emplace(boost::filesystem::last_write_time(entry.path()), name);
+        byteSize += info.size;
+    }
+    evict();
+}
+
+UniqueRaster DiskTileCache::get(const std::string &key) {
+    std::string name = fileName(key);
+    boost::filesystem::path path = boost::filesystem::path(directory) / name;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(files.find(name) == files.end()){
+            ++misses;
+            return nullptr;
+        }
+    }
+
+    //the file is read without holding the lock, it may have been evicted in the meantime.
+    UniqueRaster raster;
+    if(boost::filesystem::exists(path))
+        raster = read(path.string(), key);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = files.find(name);
+    if(raster == nullptr || it == files.end()){
+        ++misses;
+        return nullptr;
+    }
+    ++hits;
+    markUsed(it->second, name, std::time(nullptr));
+    boost::system::error_code ec;
+    boost::filesystem::last_write_time(path, it->second.usage->first, ec);
+    return raster;
+}
+
+UniqueRaster DiskTileCache::read(const std::string &path, const std::string &key) const {
+    MappedFile file(path);
+    const char *pos = file.getData();
+    const char *end = pos + file.getSize();
+
+    //the key in the header detects hash collisions, the sizes detect files that are not complete.
+    uint32_t keyLength = 0;
+    if(file.getSize() < sizeof(tileFileMagic) + sizeof(keyLength) || std::memcmp(pos, tileFileMagic, sizeof(tileFileMagic)) != 0)
+        return nullptr;
+    pos += sizeof(tileFileMagic);
+    readValue(pos, keyLength);
+    if(end - pos < static_cast<std::ptrdiff_t>(keyLength + sizeof(int32_t) + 2 * sizeof(uint32_t)) || key.compare(0, std::string::npos, pos, keyLength) != 0)
+        return nullptr;
+    pos += keyLength;
+
+    int32_t dataType = 0;
+    Resolution res;
+    readValue(pos, dataType);
+    readValue(pos, res.resX);
+    readValue(pos, res.resY);
+
+    UniqueRaster raster = Raster::createRaster(static_cast<GDALDataType>(dataType), res);
+    size_t dataSize = static_cast<size_t>(raster->getDataLength()) * raster->sizeOfDataType();
+    if(static_cast<size_t>(end - pos) < dataSize)
+        return nullptr;
+    std::memcpy(raster->getVoidDataPointer(), pos, dataSize);
+    return raster;
+}
+
+void DiskTileCache::put(const std::string &key, Raster *raster) {
+    std::string name = fileName(key);
+    boost::filesystem::path path = boost::filesystem::path(directory) / name;
+    boost::filesystem::path tempPath = path;
+    tempPath += boost::filesystem::unique_path(".%%%%-%%%%-%%%%");
+
+    size_t dataSize = static_cast<size_t>(raster->getDataLength()) * raster->sizeOfDataType();
+    {
+        std::ofstream file(tempPath.string(), std::ios::binary | std::ios::trunc);
+        file.write(tileFileMagic, sizeof(tileFileMagic));
+        writeValue(file, static_cast<uint32_t>(key.size()));
+        file.write(key.data(), key.size());
+        writeValue(file, static_cast<int32_t>(raster->getDataType()));
+        Resolution res = raster->getResolution();
+        writeValue(file, res.resX);
+        writeValue(file, res.resY);
+        file.write(static_cast<const char*>(raster->getVoidDataPointer()), dataSize);
+        if(!file){
+            boost::system::error_code ec;
+            boost::filesystem::remove(tempPath, ec);
+            throw std::runtime_error("DiskTileCache: could not write tile to " + tempPath.string());
+        }
+    }
+    boost::system::error_code renameError;
+    boost::filesystem::rename(tempPath, path, renameError);
+    if(renameError){
+        boost::system::error_code ec;
+        boost::filesystem::remove(tempPath, ec);
+        throw std::runtime_error("DiskTileCache: could not rename tile file to " + path.string() + ": " + renameError.message());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = files.find(name);
+    if(it == files.end()){
+        FileInfo &info = files[name];
+        info.size = boost::filesystem::file_size(path);
+        info.usage = usageOrder.emplace(std::time(nullptr), name);
+        byteSize += info.size;
+    } else {
+        byteSize -= it->second.size;
+        it->second.size = boost::filesystem::file_size(path);
+        byteSize += it->second.size;
+        markUsed(it->second, name, std::time(nullptr));
+    }
+    evict();
+}
+
+void DiskTileCache::markUsed(FileInfo &info, const std::string &name, std::time_t time) {
+    usageOrder.erase(info.usage);
+    info.usage = usageOrder.emplace(time, name);
+}
+
+void DiskTileCache::evict() {
+    while(byteSize > byteBudget && !usageOrder.empty()){
+        std::string name = usageOrder.begin()->second;
+        boost::system::error_code ec;
+        boost::filesystem::remove(boost::filesystem::path(directory) / name, ec);
+        byteSize -= files[name].size;
+        files.erase(name);
+        usageOrder.erase(usageOrder.begin());
+    }
+}
+
+uint64_t DiskTileCache::getHits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+uint64_t DiskTileCache::getMisses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+std::string DiskTileCache::fileName(const std::string &key) const {
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(stableHash(key)));
+    return std::string(name) + tileFileExtension;
+}
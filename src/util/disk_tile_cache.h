@@ -0,0 +1,76 @@
+
+#ifndef RASTER_TIME_SERIES_DISK_TILE_CACHE_H
+#define RASTER_TIME_SERIES_DISK_TILE_CACHE_H
+
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "datatypes/raster.h"
+
+namespace rts {
+
+    /**
+     * Persistent cache of decoded tiles in a directory, so tiles survive the query and are found again by later
+     * queries. Every tile is stored in its own file, named by a hash of its key: a short header with the key, the
+     * data type and the resolution, followed by the raw tile data. Reading maps the file into memory.
+     * Files are written to a temporary name first and renamed, so other processes never read a partial tile.
+     *
+     * The size of all files is bounded: when it exceeds the budget, the least recently used files are deleted.
+     * Reading a tile updates the modification time of its file, that is the usage order across queries.
+     *
+     * All methods are thread safe. Use open() to get the cache of a directory, it is shared by all users in the process.
+     */
+    class DiskTileCache {
+    public:
+        /**
+         * @param directory Directory of the cache, created if it does not exist.
+         * @param byteBudget Maximum size of all tile files in bytes, only used when the cache is opened the first time.
+         * @return The cache of the directory, shared by all callers in this process.
+         */
+        static std::shared_ptr<DiskTileCache> open(const std::string &directory, uint64_t byteBudget);
+
+        DiskTileCache(const std::string &directory, uint64_t byteBudget);
+        DiskTileCache(const DiskTileCache &other) = delete;
+        DiskTileCache& operator=(const DiskTileCache &other) = delete;
+
+        /**
+         * @return The cached tile or nullptr, if there is no tile for the key.
+         */
+        UniqueRaster get(const std::string &key);
+
+        /**
+         * Writes the tile to the cache and deletes least recently used tiles when the budget is exceeded.
+         * Throws a std::runtime_error when the tile can not be written, no partial file is left behind.
+         */
+        void put(const std::string &key, Raster *raster);
+
+        uint64_t getHits() const;
+        uint64_t getMisses() const;
+
+    private:
+        struct FileInfo {
+            uint64_t size;
+            std::multimap<std::time_t, std::string>::iterator usage;
+        };
+
+        std::string fileName(const std::string &key) const;
+        UniqueRaster read(const std::string &path, const std::string &key) const;
+        void markUsed(FileInfo &info, const std::string &name, std::time_t time);
+        void evict();
+
+        std::string directory;
+        uint64_t byteBudget;
+        uint64_t byteSize;
+        uint64_t hits;
+        uint64_t misses;
+        std::map<std::string, FileInfo> files;
+        //file names ordered by their last use, the least recently used first.
+        std::multimap<std::time_t, std::string> usageOrder;
+        mutable std::mutex mutex;
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_DISK_TILE_CACHE_H
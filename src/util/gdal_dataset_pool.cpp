@@ -0,0 +1,190 @@
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include "util/gdal_dataset_pool.h"
+
+using namespace rts;
+
+bool GdalBandInfo::sameGeometry(const GdalBandInfo &other) const {
+    if(originX != other.originX || originY != other.originY || scaleX != other.scaleX || scaleY != other.scaleY
+       || sizeX != other.sizeX || sizeY != other.sizeY || overviews.size() != other.overviews.size())
+        return false;
+    for(size_t i = 0; i < overviews.size(); ++i){
+        if(overviews[i].index != other.overviews[i].index || overviews[i].sizeX != other.overviews[i].sizeX
+           || overviews[i].sizeY != other.overviews[i].sizeY)
+            return false;
+    }
+    return true;
+}
+
+GdalDatasetPool::Lease::Lease(std::shared_ptr<GdalDatasetPool> pool, std::string path, GDALDataset *dataset)
+        : pool(std::move(pool)), path(std::move(path)), dataset(dataset)
+{
+
+}
+
+GdalDatasetPool::Lease::Lease(Lease &&other) noexcept
+        : pool(std::move(other.pool)), path(std::move(other.path)), dataset(other.dataset)
+{
+    other.dataset = nullptr;
+}
+
+GdalDatasetPool::Lease& GdalDatasetPool::Lease::operator=(Lease &&other) noexcept {
+    if(this != &other){
+        release();
+        pool = std::move(other.pool);
+        path = std::move(other.path);
+        dataset = other.dataset;
+        other.dataset = nullptr;
+    }
+    return *this;
+}
+
+GdalDatasetPool::Lease::~Lease() {
+    release();
+}
+
+void GdalDatasetPool::Lease::release() {
+    if(dataset != nullptr)
+        pool->giveBack(path, dataset);
+    dataset = nullptr;
+    pool = nullptr;
+}
+
+GDALDataset* GdalDatasetPool::Lease::get() const {
+    return dataset;
+}
+
+GDALDataset* GdalDatasetPool::Lease::operator->() const {
+    return dataset;
+}
+
+GdalDatasetPool::Lease::operator bool() const {
+    return dataset != nullptr;
+}
+
+GdalDatasetPool::GdalDatasetPool(size_t maxOpen) : maxOpen(std::max<size_t>(1, maxOpen)), openCount(0) {
+
+}
+
+GdalDatasetPool::~GdalDatasetPool() {
+    for(auto &entry : entries){
+        close(entry.dataset);
+    }
+}
+
+GdalDatasetPool::Lease GdalDatasetPool::lease(const std::string &path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(path);
+        if(it != index.end()){
+            GDALDataset *dataset = it->second->dataset;
+            entries.erase(it->second);
+            index.erase(it);
+            return Lease(shared_from_this(), path, dataset);
+        }
+        ++openCount;
+    }
+
+    //opened without the lock, so other threads can lease or open datasets in the meantime.
+    auto dataset = (GDALDataset *)GDALOpen(path.c_str(), GA_ReadOnly);
+    if(dataset == nullptr){
+        throw std::runtime_error("GDAL dataset could not be opened: " + path);
+    }
+    return Lease(shared_from_this(), path, dataset);
+}
+
+void GdalDatasetPool::giveBack(const std::string &path, GDALDataset *dataset) {
+    std::vector<GDALDataset*> closed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        entries.push_front(Entry{path, dataset});
+        index.emplace(path, entries.begin());
+        while(entries.size() > maxOpen){
+            auto last = std::prev(entries.end());
+            auto range = index.equal_range(last->path);
+            for(auto it = range.first; it != range.second; ++it){
+                if(it->second == last){
+                    index.erase(it);
+                    break;
+                }
+            }
+            closed.push_back(last->dataset);
+            entries.erase(last);
+        }
+    }
+    for(GDALDataset *d : closed){
+        close(d);
+    }
+}
+
+std::shared_ptr<const GdalBandInfo> GdalDatasetPool::getBandInfo(const std::string &path, int channel) {
+    auto key = std::make_pair(path, channel);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = bandInfos.find(key);
+        if(it != bandInfos.end())
+            return it->second;
+    }
+
+    Lease dataset = lease(path);
+    auto info = std::make_shared<const GdalBandInfo>(readBandInfo(dataset.get(), path, channel));
+    dataset.release();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    //another thread may have read it in the meantime, all users should share the same record.
+    return bandInfos.emplace(std::move(key), std::move(info)).first->second;
+}
+
+GdalBandInfo GdalDatasetPool::readBandInfo(GDALDataset *dataset, const std::string &path, int channel) {
+    GDALRasterBand *band = dataset->GetRasterBand(channel);
+    if(band == nullptr){
+        throw std::runtime_error("GDAL dataset has no band " + std::to_string(channel) + ": " + path);
+    }
+    double geoTransform[6];
+    if(dataset->GetGeoTransform(geoTransform) != CE_None){
+        throw std::runtime_error("GDAL dataset has no GeoTransform information: " + path);
+    }
+
+    GdalBandInfo info;
+    info.originX = geoTransform[0];
+    info.originY = geoTransform[3];
+    info.scaleX = geoTransform[1];
+    info.scaleY = geoTransform[5];
+    info.sizeX = band->GetXSize();
+    info.sizeY = band->GetYSize();
+    if(info.scaleY < 0){
+        info.originY = info.originY + info.scaleY * info.sizeY;
+        info.scaleY *= -1;
+    }
+    band->GetBlockSize(&info.blockX, &info.blockY);
+    info.nodata = band->GetNoDataValue();
+    info.dataType = band->GetRasterDataType();
+
+    for(int i = 0; i < band->GetOverviewCount(); ++i){
+        GDALRasterBand *overview = band->GetOverview(i);
+        if(overview == nullptr || overview->GetXSize() == 0)
+            continue;
+        GdalBandInfo::Overview o;
+        o.index = i;
+        o.sizeX = overview->GetXSize();
+        o.sizeY = overview->GetYSize();
+        overview->GetBlockSize(&o.blockX, &o.blockY);
+        info.overviews.push_back(o);
+    }
+    return info;
+}
+
+void GdalDatasetPool::close(GDALDataset *dataset) {
+    GDALClose(dataset);
+}
+
+uint64_t GdalDatasetPool::getOpenCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return openCount;
+}
+
+size_t GdalDatasetPool::getMaxOpen() const {
+    return maxOpen;
+}
@@ -0,0 +1,143 @@
+
+#ifndef RASTER_TIME_SERIES_GDAL_DATASET_POOL_H
+#define RASTER_TIME_SERIES_GDAL_DATASET_POOL_H
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <gdal_priv.h>
+
+namespace rts {
+
+    /**
+     * Metadata of a band of a GDAL dataset that is needed for reading tiles from it.
+     * It is read once per file by the GdalDatasetPool, so reading a tile does not query the dataset for it.
+     */
+    struct GdalBandInfo {
+        /**
+         * An overview of the band, index is the index for GDALRasterBand::GetOverview.
+         */
+        struct Overview {
+            int index;
+            int sizeX;
+            int sizeY;
+            int blockX;
+            int blockY;
+        };
+
+        //GDAL often has a positive y origin and a negative scale, originY is the smaller coordinate and scaleY positive.
+        double originX;
+        double originY;
+        double scaleX;
+        double scaleY;
+        int sizeX;
+        int sizeY;
+        int blockX;
+        int blockY;
+        double nodata;
+        GDALDataType dataType;
+        std::vector<Overview> overviews;
+
+        /**
+         * @return If the pixels of both bands and their overviews are at the same positions, so the same windows are read for a tile.
+         */
+        bool sameGeometry(const GdalBandInfo &other) const;
+    };
+
+    /**
+     * Pool of open GDAL datasets, so files that are read again are not opened again.
+     * A GDAL dataset must not be used from multiple threads at once, so every user leases a dataset exclusively and
+     * gives it back to the pool when the lease is destructed. When all open datasets of a file are leased, another
+     * dataset of the same file is opened. So tiles of the same file, and of different files, can be read in parallel.
+     *
+     * Up to a maximum number of datasets is kept open while they are not leased. When a returned dataset does not
+     * fit, the least recently used dataset is closed.
+     * The pool of a query is shared by all its source operators, see OperatorTree::getDatasetPool().
+     * All methods are thread safe. The pool must be created with std::make_shared, leases keep it alive.
+     */
+    class GdalDatasetPool : public std::enable_shared_from_this<GdalDatasetPool> {
+    public:
+        /**
+         * Exclusive use of an open dataset until the lease is destructed or released.
+         */
+        class Lease {
+        public:
+            Lease() = default;
+            ~Lease();
+            Lease(Lease &&other) noexcept;
+            Lease& operator=(Lease &&other) noexcept;
+            Lease(const Lease &other) = delete;
+            Lease& operator=(const Lease &other) = delete;
+
+            GDALDataset* get() const;
+            GDALDataset* operator->() const;
+            explicit operator bool() const;
+
+            /**
+             * Gives the dataset back to the pool, the lease is empty afterwards.
+             */
+            void release();
+
+        private:
+            friend class GdalDatasetPool;
+            Lease(std::shared_ptr<GdalDatasetPool> pool, std::string path, GDALDataset *dataset);
+
+            std::shared_ptr<GdalDatasetPool> pool;
+            std::string path;
+            GDALDataset *dataset = nullptr;
+        };
+
+        explicit GdalDatasetPool(size_t maxOpen);
+        ~GdalDatasetPool();
+        GdalDatasetPool(const GdalDatasetPool &other) = delete;
+        GdalDatasetPool& operator=(const GdalDatasetPool &other) = delete;
+
+        /**
+         * @return An open dataset of the file that is not used by anybody else, opened read only if there is none.
+         * Throws a std::runtime_error when the file can not be opened.
+         */
+        Lease lease(const std::string &path);
+
+        /**
+         * @return How often a dataset was opened, not counting the datasets found in the pool.
+         */
+        uint64_t getOpenCount() const;
+
+        /**
+         * @return The metadata of a band of the file. It is read only the first time, when the file is leased for it.
+         * Throws a std::runtime_error when the file can not be opened or has no geotransform.
+         */
+        std::shared_ptr<const GdalBandInfo> getBandInfo(const std::string &path, int channel);
+        size_t getMaxOpen() const;
+
+    private:
+        struct Entry {
+            std::string path;
+            GDALDataset *dataset;
+        };
+
+        static void close(GDALDataset *dataset);
+        static GdalBandInfo readBandInfo(GDALDataset *dataset, const std::string &path, int channel);
+
+        /**
+         * Stores a dataset that is not leased anymore as the most recently used one.
+         */
+        void giveBack(const std::string &path, GDALDataset *dataset);
+
+        //not leased datasets, most recently used first.
+        std::list<Entry> entries;
+        std::unordered_multimap<std::string, std::list<Entry>::iterator> index;
+        //kept for closed datasets too, they are small.
+        std::map<std::pair<std::string, int>, std::shared_ptr<const GdalBandInfo>> bandInfos;
+        size_t maxOpen;
+        uint64_t openCount;
+        mutable std::mutex mutex;
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_GDAL_DATASET_POOL_H
@@ -0,0 +1,85 @@
+
+#include <stdexcept>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "util/mapped_file.h"
+
+using namespace rts;
+
+MappedRegion::MappedRegion(void *mapping, size_t mappingSize, size_t dataOffset)
+        : mapping(mapping), mappingSize(mappingSize), dataOffset(dataOffset)
+{
+
+}
+
+MappedRegion::~MappedRegion() {
+    munmap(mapping, mappingSize);
+}
+
+char* MappedRegion::getData() {
+    return static_cast<char*>(mapping) + dataOffset;
+}
+
+MappedFile::MappedFile(const std::string &path) : fileDescriptor(-1), data(nullptr), size(0) {
+    fileDescriptor = open(path.c_str(), O_RDONLY);
+    if(fileDescriptor < 0)
+        throw std::runtime_error("MappedFile: could not open file " + path);
+
+    struct stat fileStat{};
+    if(fstat(fileDescriptor, &fileStat) != 0){
+        close(fileDescriptor);
+        throw std::runtime_error("MappedFile: could not read size of file " + path);
+    }
+    size = static_cast<size_t>(fileStat.st_size);
+
+    if(size > 0){
+        data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+        if(data == MAP_FAILED){
+            close(fileDescriptor);
+            throw std::runtime_error("MappedFile: could not map file " + path);
+        }
+    }
+}
+
+MappedFile::~MappedFile() {
+    if(data != nullptr)
+        munmap(data, size);
+    if(fileDescriptor >= 0)
+        close(fileDescriptor);
+}
+
+const char* MappedFile::getData() const {
+    return static_cast<const char*>(data);
+}
+
+size_t MappedFile::getSize() const {
+    return size;
+}
+
+void MappedFile::adviseSequential(size_t offset, size_t length) const {
+    if(data == nullptr || offset >= size)
+        return;
+    //madvise needs a page aligned start address.
+    auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t alignedOffset = offset - offset % pageSize;
+    length = std::min(length + (offset - alignedOffset), size - alignedOffset);
+    //the advice values are no flags, so two calls are needed.
+    madvise(static_cast<char*>(data) + alignedOffset, length, MADV_SEQUENTIAL);
+    madvise(static_cast<char*>(data) + alignedOffset, length, MADV_WILLNEED);
+}
+
+std::unique_ptr<MappedRegion> MappedFile::mapPrivate(size_t offset, size_t length) const {
+    if(length == 0 || offset > size || length > size - offset)
+        return nullptr;
+    //mmap needs a page aligned file offset.
+    auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t alignedOffset = offset - offset % pageSize;
+    size_t mappingSize = length + (offset - alignedOffset);
+    void *mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, static_cast<off_t>(alignedOffset));
+    if(mapping == MAP_FAILED)
+        return nullptr;
+    return std::make_unique<MappedRegion>(mapping, mappingSize, offset - alignedOffset);
+}
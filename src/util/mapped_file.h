@@ -0,0 +1,77 @@
+
+#ifndef RASTER_TIME_SERIES_MAPPED_FILE_H
+#define RASTER_TIME_SERIES_MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+#include <memory>
+
+namespace rts {
+
+    /**
+     * Private memory mapping of a part of a file, see MappedFile::mapPrivate. Writing to it is copy on write: the
+     * written pages are copied for this mapping, the file and other mappings of it do not change.
+     */
+    class MappedRegion {
+    public:
+        MappedRegion(void *mapping, size_t mappingSize, size_t dataOffset);
+        ~MappedRegion();
+        MappedRegion(const MappedRegion &other) = delete;
+        MappedRegion& operator=(const MappedRegion &other) = delete;
+
+        /**
+         * @return Pointer to the first byte of the requested part of the file.
+         */
+        char* getData();
+
+    private:
+        void *mapping;
+        size_t mappingSize;
+        size_t dataOffset;
+    };
+
+    /**
+     * Read only memory mapping of a whole file. The mapped pages are loaded by the operating system on access and
+     * can be evicted again under memory pressure, so reading from big files does not need heap memory.
+     */
+    class MappedFile {
+    public:
+        /**
+         * Maps the file, throws a std::runtime_error when the file can not be opened or mapped.
+         */
+        explicit MappedFile(const std::string &path);
+        ~MappedFile();
+        MappedFile(const MappedFile &other) = delete;
+        MappedFile& operator=(const MappedFile &other) = delete;
+
+        /**
+         * @return Pointer to the first byte of the file, nullptr for an empty file.
+         */
+        const char* getData() const;
+
+        /**
+         * @return The size of the file in bytes.
+         */
+        size_t getSize() const;
+
+        /**
+         * Tells the operating system that the range will be read sequentially, so it can read ahead.
+         */
+        void adviseSequential(size_t offset, size_t length) const;
+
+        /**
+         * Maps a part of the file again as private, writable mapping. The part is not copied, its pages are shared
+         * with the page cache until they are written to.
+         * @return The mapping, nullptr when the part is outside of the file or can not be mapped.
+         */
+        std::unique_ptr<MappedRegion> mapPrivate(size_t offset, size_t length) const;
+
+    private:
+        int fileDescriptor;
+        void *data;
+        size_t size;
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_MAPPED_FILE_H
@@ -0,0 +1,62 @@
+
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include "util/parallel.h"
+
+using namespace rts;
+
+uint32_t Parallel::resolveThreadCount(uint32_t requested) {
+    if(requested > 0)
+        return requested;
+    uint32_t hardware = std::thread::hardware_concurrency();
+    return hardware > 0 ? hardware : 1;
+}
+
+void Parallel::forEach(uint32_t count, uint32_t threadCount, const std::function<void(uint32_t, uint32_t)> &func) {
+    threadCount = std::min(threadCount, count);
+
+    if(threadCount <= 1){
+        for(uint32_t i = 0; i < count; ++i){
+            func(i, 0);
+        }
+        return;
+    }
+
+    std::atomic<uint32_t> nextIndex(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr firstException = nullptr;
+    std::mutex exceptionMutex;
+
+    auto work = [&](uint32_t threadIndex){
+        while(!failed){
+            uint32_t index = nextIndex++;
+            if(index >= count)
+                return;
+            try {
+                func(index, threadIndex);
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if(!firstException)
+                    firstException = std::current_exception();
+                failed = true;
+            }
+        }
+    };
+
+    //the calling thread works as well, so only start threadCount - 1 additional threads.
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for(uint32_t t = 1; t < threadCount; ++t){
+        threads.emplace_back(work, t);
+    }
+    work(0);
+    for(auto &thread : threads){
+        thread.join();
+    }
+
+    if(firstException)
+        std::rethrow_exception(firstException);
+}
@@ -0,0 +1,36 @@
+
+#ifndef RASTER_TIME_SERIES_PARALLEL_H
+#define RASTER_TIME_SERIES_PARALLEL_H
+
+#include <functional>
+#include <cstdint>
+
+namespace rts {
+
+    /**
+     * Utility class for executing work on multiple threads.
+     */
+    class Parallel {
+    public:
+        /**
+         * @param requested Number of threads requested by a parameter. 0 means one thread per core.
+         * @return The number of threads to use, at least 1.
+         */
+        static uint32_t resolveThreadCount(uint32_t requested);
+
+        /**
+         * Calls func for all indices in [0, count) using up to threadCount threads. The indices are distributed
+         * dynamically, so threads that finish their work early take over the next index.
+         * Blocks until all indices are processed. If func throws, the remaining indices are not processed anymore
+         * and the first exception is rethrown on the calling thread.
+         * @param count Number of indices to process.
+         * @param threadCount Maximum number of threads to use. With 1 everything is executed on the calling thread.
+         * @param func Function called with the index to process and the index of the executing thread,
+         *             which is in [0, threadCount) and can be used to access thread local data.
+         */
+        static void forEach(uint32_t count, uint32_t threadCount, const std::function<void(uint32_t index, uint32_t threadIndex)> &func);
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_PARALLEL_H
@@ -51,6 +51,8 @@ AggregatorFunction Parsing::parseAggregatorFunction(const std::string &input) {
         return AggregatorFunction::Max;
     else if(input == "Sum")
         return AggregatorFunction::Sum;
+    else if(input == "Quantile" || input == "Median")
+        return AggregatorFunction::Quantile;
     else
         throw std::runtime_error("Could not parse AggregatorFunction: " + input);
 }
@@ -120,6 +120,8 @@ SpatialReference RasterCalculations::tileIndexToSpatialRectangle(const QueryRect
 std::pair<Resolution, Resolution>
 RasterCalculations::calculateTileCount(const QueryRectangle &qrect, const Origin &origin, const Scale &scale) {
     std::pair<Resolution, Resolution> result;
+    if(qrect.hasAutoTileRes())
+        throw std::runtime_error("The tileRes of the query rectangle is 0 or \"auto\" and was not resolved by an OperatorTree.");
 
     auto rasterWorldPixelStart = RasterCalculations::coordinateToPixel(scale, origin, qrect.x1, qrect.y1);
 
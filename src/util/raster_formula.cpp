@@ -0,0 +1,238 @@
+
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include "util/raster_formula.h"
+#include "datatypes/accumulator.h"
+
+using namespace rts;
+using namespace std::string_literals;
+
+namespace {
+
+    /**
+     * Value on the evaluation stack, either a single number or the values of all pixels of the tile.
+     */
+    struct Slot {
+        std::vector<double> values;
+        double constant = 0;
+        bool isConstant = true;
+    };
+
+    template<class F>
+    void applyBinary(Slot &a, const Slot &b, size_t length, F f) {
+        if(a.isConstant && b.isConstant){
+            a.constant = f(a.constant, b.constant);
+        } else if(a.isConstant){
+            a.values.resize(length);
+            for(size_t i = 0; i < length; ++i)
+                a.values[i] = f(a.constant, b.values[i]);
+            a.isConstant = false;
+        } else if(b.isConstant){
+            for(size_t i = 0; i < length; ++i)
+                a.values[i] = f(a.values[i], b.constant);
+        } else {
+            for(size_t i = 0; i < length; ++i)
+                a.values[i] = f(a.values[i], b.values[i]);
+        }
+    }
+
+    int precedence(char op) {
+        switch(op){
+            case '+':
+            case '-':
+                return 1;
+            case '*':
+            case '/':
+            case '%':
+                return 2;
+            default: //unary minus
+                return 3;
+        }
+    }
+
+    template<class T>
+    struct FormulaInputReader {
+        static void rasterOperation(TypedRaster<T> *raster, double *values, uint8_t *valid, double nodata) {
+            const T *in = raster->getDataPointer();
+            const T nodataTyped = static_cast<T>(nodata);
+            for(int i = 0; i < raster->getDataLength(); ++i){
+                values[i] = static_cast<double>(in[i]);
+                if(!isValidCell(in[i], nodataTyped))
+                    valid[i] = 0;
+            }
+        }
+    };
+
+    template<class T>
+    struct FormulaOutputWriter {
+        static void rasterOperation(TypedRaster<T> *out, const Slot *result, const uint8_t *valid, double nodata) {
+            T *outData = out->getDataPointer();
+            const T nodataTyped = static_cast<T>(nodata);
+            for(int i = 0; i < out->getDataLength(); ++i){
+                double v = result->isConstant ? result->constant : result->values[i];
+                outData[i] = valid[i] && std::isfinite(v) ? clampedCast<T>(v, nodataTyped) : nodataTyped;
+            }
+        }
+    };
+
+}
+
+RasterFormula::RasterFormula(const std::string &formula) {
+    //shunting-yard algorithm, '~' is the unary minus and '(' an open parenthesis on the operator stack.
+    std::vector<char> operators;
+    auto emit = [this](char op){
+        switch(op){
+            case '+': program.push_back({StepType::Add, 0, 0}); break;
+            case '-': program.push_back({StepType::Sub, 0, 0}); break;
+            case '*': program.push_back({StepType::Mul, 0, 0}); break;
+            case '/': program.push_back({StepType::Div, 0, 0}); break;
+            case '%': program.push_back({StepType::Mod, 0, 0}); break;
+            default:  program.push_back({StepType::Negate, 0, 0}); break;
+        }
+    };
+
+    bool expectOperand = true;
+    size_t pos = 0;
+    while(pos < formula.size()){
+        char c = formula[pos];
+        if(std::isspace(static_cast<unsigned char>(c))){
+            ++pos;
+        } else if(expectOperand){
+            if(c >= 'A' && c <= 'Z'){
+                auto input = static_cast<uint32_t>(c - 'A');
+                if(usedInputs.size() <= input)
+                    usedInputs.resize(input + 1, false);
+                usedInputs[input] = true;
+                program.push_back({StepType::Raster, 0, input});
+                expectOperand = false;
+                ++pos;
+            } else if(std::isdigit(static_cast<unsigned char>(c)) || c == '.'){
+                const char *start = formula.c_str() + pos;
+                char *end = nullptr;
+                double number = std::strtod(start, &end);
+                if(end == start)
+                    throw std::runtime_error("RasterFormula: invalid number in formula: "s + formula);
+                program.push_back({StepType::Number, number, 0});
+                expectOperand = false;
+                pos += end - start;
+            } else if(c == '(' || c == '-'){
+                operators.push_back(c == '(' ? '(' : '~');
+                ++pos;
+            } else if(c == '+'){
+                ++pos;
+            } else {
+                throw std::runtime_error("RasterFormula: expected a raster, number, or '(' at position "s + std::to_string(pos) + " in formula: " + formula);
+            }
+        } else {
+            if(c == ')'){
+                while(!operators.empty() && operators.back() != '('){
+                    emit(operators.back());
+                    operators.pop_back();
+                }
+                if(operators.empty())
+                    throw std::runtime_error("RasterFormula: unbalanced parentheses in formula: "s + formula);
+                operators.pop_back();
+                ++pos;
+            } else if(c == '+' || c == '-' || c == '*' || c == '/' || c == '%'){
+                while(!operators.empty() && operators.back() != '(' && precedence(operators.back()) >= precedence(c)){
+                    emit(operators.back());
+                    operators.pop_back();
+                }
+                operators.push_back(c);
+                expectOperand = true;
+                ++pos;
+            } else {
+                throw std::runtime_error("RasterFormula: expected an operator or ')' at position "s + std::to_string(pos) + " in formula: " + formula);
+            }
+        }
+    }
+
+    if(expectOperand)
+        throw std::runtime_error("RasterFormula: incomplete formula: "s + formula);
+    while(!operators.empty()){
+        if(operators.back() == '(')
+            throw std::runtime_error("RasterFormula: unbalanced parentheses in formula: "s + formula);
+        emit(operators.back());
+        operators.pop_back();
+    }
+    if(usedInputs.empty())
+        throw std::runtime_error("RasterFormula: invalid formula (no rasters inserted): "s + formula);
+}
+
+uint32_t RasterFormula::getInputCount() const {
+    return static_cast<uint32_t>(usedInputs.size());
+}
+
+bool RasterFormula::usesInput(uint32_t index) const {
+    return index < usedInputs.size() && usedInputs[index];
+}
+
+void RasterFormula::evaluate(const std::vector<UniqueRaster> &inputs, const std::vector<double> &inputNodata, Raster *out, double outNodata) const {
+    if(inputs.size() < usedInputs.size())
+        throw std::runtime_error("RasterFormula: received less inputs than the formula uses.");
+
+    auto length = static_cast<size_t>(out->getDataLength());
+    std::vector<uint8_t> valid(length, 1);
+    std::vector<std::vector<double>> inputValues(usedInputs.size());
+    for(uint32_t i = 0; i < usedInputs.size(); ++i){
+        if(!usedInputs[i])
+            continue;
+        if(inputs[i] == nullptr || static_cast<size_t>(inputs[i]->getDataLength()) != length)
+            throw std::runtime_error("RasterFormula: input raster does not match the output raster.");
+        inputValues[i].resize(length);
+        RasterOperations::callUnary<FormulaInputReader>(inputs[i].get(), inputValues[i].data(), valid.data(), inputNodata[i]);
+    }
+
+    std::vector<Slot> stack;
+    for(const Step &step : program){
+        if(step.type == StepType::Raster){
+            Slot slot;
+            slot.values = inputValues[step.input];
+            slot.isConstant = false;
+            stack.push_back(std::move(slot));
+            continue;
+        }
+        if(step.type == StepType::Number){
+            Slot slot;
+            slot.constant = step.number;
+            stack.push_back(std::move(slot));
+            continue;
+        }
+        if(step.type == StepType::Negate){
+            Slot &a = stack.back();
+            if(a.isConstant){
+                a.constant = -a.constant;
+            } else {
+                for(double &v : a.values)
+                    v = -v;
+            }
+            continue;
+        }
+
+        Slot b = std::move(stack.back());
+        stack.pop_back();
+        Slot &a = stack.back();
+        switch(step.type){
+            case StepType::Add:
+                applyBinary(a, b, length, [](double x, double y){ return x + y; });
+                break;
+            case StepType::Sub:
+                applyBinary(a, b, length, [](double x, double y){ return x - y; });
+                break;
+            case StepType::Mul:
+                applyBinary(a, b, length, [](double x, double y){ return x * y; });
+                break;
+            case StepType::Div:
+                applyBinary(a, b, length, [](double x, double y){ return x / y; });
+                break;
+            case StepType::Mod:
+                applyBinary(a, b, length, [](double x, double y){ return std::fmod(x, y); });
+                break;
+            default:
+                break;
+        }
+    }
+
+    RasterOperations::callUnary<FormulaOutputWriter>(out, &stack.back(), valid.data(), outNodata);
+}
@@ -0,0 +1,69 @@
+
+#ifndef RASTER_TIME_SERIES_RASTER_FORMULA_H
+#define RASTER_TIME_SERIES_RASTER_FORMULA_H
+
+#include <string>
+#include <vector>
+#include "datatypes/raster.h"
+
+namespace rts {
+
+    /**
+     * Arithmetic formula over any number of input rasters, e.g. "(A + B) * C - 0.5".
+     * Rasters are represented by the capital letters A to Z, A is the first input raster, B the second and so on.
+     * Supported are numbers, the operators +,-,*,/,% (modulo on floating point values), unary minus and parentheses.
+     *
+     * The formula is compiled once into a postfix program. It is evaluated for a whole tile at once, every step of
+     * the program works on arrays of all pixels of the tile, so the program is only interpreted once per tile.
+     * The calculation is done in double. A result pixel is nodata when one of the used input pixels is nodata
+     * or the result is not finite, e.g. after a division by zero. Results outside of the value range of the output
+     * data type are clamped to it.
+     */
+    class RasterFormula {
+    public:
+        explicit RasterFormula(const std::string &formula);
+
+        /**
+         * @return The number of inputs the formula expects, defined by the highest letter used.
+         */
+        uint32_t getInputCount() const;
+
+        /**
+         * @return If the input with the index is part of the formula. Unused inputs do not have to be loaded.
+         */
+        bool usesInput(uint32_t index) const;
+
+        /**
+         * Evaluates the formula for all pixels of the output raster.
+         * @param inputs Input rasters with the same resolution as the output, unused inputs can be nullptr.
+         * @param inputNodata The nodata values of the inputs.
+         * @param out Output raster, can be of any data type.
+         * @param outNodata Nodata value of the output raster.
+         */
+        void evaluate(const std::vector<UniqueRaster> &inputs, const std::vector<double> &inputNodata, Raster *out, double outNodata) const;
+
+    private:
+        enum class StepType {
+            Raster,
+            Number,
+            Add,
+            Sub,
+            Mul,
+            Div,
+            Mod,
+            Negate
+        };
+
+        struct Step {
+            StepType type;
+            double number;
+            uint32_t input;
+        };
+
+        std::vector<Step> program;
+        std::vector<bool> usedInputs;
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_RASTER_FORMULA_H
@@ -0,0 +1,132 @@
+
+#include <cstring>
+#include <functional>
+#include "util/tile_cache.h"
+#include "util/tile_codec.h"
+
+using namespace rts;
+
+bool TileCacheKey::operator==(const TileCacheKey &other) const {
+    return time == other.time && x == other.x && y == other.y && dataType == other.dataType
+           && resX == other.resX && resY == other.resY;
+}
+
+size_t TileCacheKeyHash::operator()(const TileCacheKey &key) const {
+    std::hash<double> hash;
+    size_t h = hash(key.time);
+    h ^= hash(key.x) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= hash(key.y) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= std::hash<int>()(key.dataType) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= std::hash<uint64_t>()(static_cast<uint64_t>(key.resX) << 32 | key.resY) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+}
+
+TileCache::TileCache(size_t byteBudget, bool compress)
+        : byteBudget(byteBudget), byteSize(0), decodedByteSize(0), compress(compress), hits(0), misses(0), evictions(0)
+{
+
+}
+
+UniqueRaster TileCache::get(const TileCacheKey &key) {
+    std::shared_ptr<const std::vector<uint8_t>> encoded;
+    UniqueRaster copy;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if(it == index.end()){
+            ++misses;
+            return nullptr;
+        }
+        ++hits;
+        //move the tile to the front, it is the most recently used now.
+        entries.splice(entries.begin(), entries, it->second);
+
+        Entry &entry = *it->second;
+        copy = Raster::createRaster(entry.dataType, entry.resolution);
+        if(entry.raster != nullptr)
+            std::memcpy(copy->getVoidDataPointer(), entry.raster->getVoidDataPointer(), entry.byteSize);
+        else
+            encoded = entry.encoded;
+    }
+
+    //the shared encoded data stays valid even if the tile is evicted while decoding.
+    if(encoded != nullptr)
+        TileCodec::decode(encoded->data(), encoded->size(), copy.get());
+    return copy;
+}
+
+void TileCache::put(const TileCacheKey &key, Raster *raster) {
+    size_t decodedSize = static_cast<size_t>(raster->getDataLength()) * raster->sizeOfDataType();
+    if(!compress && decodedSize > byteBudget)
+        return;
+
+    Entry entry{key, nullptr, nullptr, raster->getDataType(), raster->getResolution(), decodedSize, decodedSize};
+    if(compress){
+        auto encoded = std::make_shared<std::vector<uint8_t>>();
+        TileCodec::encode(raster, *encoded);
+        entry.byteSize = encoded->size();
+        entry.encoded = std::move(encoded);
+        if(entry.byteSize > byteBudget)
+            return;
+    } else {
+        entry.raster = Raster::createRaster(raster->getDataType(), raster->getResolution());
+        std::memcpy(entry.raster->getVoidDataPointer(), raster->getVoidDataPointer(), decodedSize);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if(it != index.end()){
+        //another thread loaded the same tile in the meantime.
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+    evict(entry.byteSize);
+    byteSize += entry.byteSize;
+    decodedByteSize += entry.decodedByteSize;
+    entries.push_front(std::move(entry));
+    index[key] = entries.begin();
+}
+
+void TileCache::evict(size_t additionalBytes) {
+    while(!entries.empty() && byteSize + additionalBytes > byteBudget){
+        Entry &last = entries.back();
+        byteSize -= last.byteSize;
+        decodedByteSize -= last.decodedByteSize;
+        index.erase(last.key);
+        entries.pop_back();
+        ++evictions;
+    }
+}
+
+uint64_t TileCache::getHits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+uint64_t TileCache::getMisses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+uint64_t TileCache::getEvictions() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return evictions;
+}
+
+size_t TileCache::getByteSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return byteSize;
+}
+
+size_t TileCache::getDecodedByteSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return decodedByteSize;
+}
+
+size_t TileCache::getByteBudget() const {
+    return byteBudget;
+}
+
+bool TileCache::isCompressed() const {
+    return compress;
+}
@@ -0,0 +1,108 @@
+
+#ifndef RASTER_TIME_SERIES_TILE_CACHE_H
+#define RASTER_TIME_SERIES_TILE_CACHE_H
+
+#include <list>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+#include "datatypes/raster.h"
+
+namespace rts {
+
+    /**
+     * Identifies a tile independent of the query it was returned for: the start time of its raster, the
+     * coordinates of its lower left corner, its data type and its resolution. So the same tile has the same key in an
+     * operator that was re-instantiated with a smaller query rectangle, where its tile index differs, but a tile that
+     * is cut at the border of that query rectangle does not get the data of the whole tile.
+     */
+    struct TileCacheKey {
+        double time;
+        double x;
+        double y;
+        GDALDataType dataType;
+        uint32_t resX;
+        uint32_t resY;
+        bool operator==(const TileCacheKey &other) const;
+    };
+
+    struct TileCacheKeyHash {
+        size_t operator()(const TileCacheKey &key) const;
+    };
+
+    /**
+     * In memory cache for tiles of any number of rasters, bounded by a budget in bytes. When a new tile does not fit
+     * into the budget, the least recently used tiles are evicted. Tiles are copied when put into and when returned
+     * from the cache, so evicting never invalidates a returned raster.
+     * When compression is enabled, the tiles are stored encoded with the TileCodec and only the encoded size counts
+     * against the budget. They are decoded on a hit, outside of the lock, so multiple threads can decode in parallel.
+     * All methods are thread safe, because the getters of descriptors can be called from multiple threads.
+     */
+    class TileCache {
+    public:
+        /**
+         * @param byteBudget Maximum size of the cached tiles in bytes.
+         * @param compress If the tiles are stored encoded with the TileCodec.
+         */
+        explicit TileCache(size_t byteBudget, bool compress = false);
+        TileCache(const TileCache &other) = delete;
+        TileCache& operator=(const TileCache &other) = delete;
+
+        /**
+         * @return A copy of the cached tile or nullptr, if it is not cached. Counts as a hit or a miss.
+         */
+        UniqueRaster get(const TileCacheKey &key);
+
+        /**
+         * Stores a copy of the raster as the most recently used tile. Tiles bigger than the budget are not stored.
+         */
+        void put(const TileCacheKey &key, Raster *raster);
+
+        uint64_t getHits() const;
+        uint64_t getMisses() const;
+        uint64_t getEvictions() const;
+
+        /**
+         * @return The size of the data of all cached tiles in bytes, after encoding them when compression is enabled.
+         */
+        size_t getByteSize() const;
+
+        /**
+         * @return The size of the data of all cached tiles in bytes when they are decoded.
+         */
+        size_t getDecodedByteSize() const;
+        size_t getByteBudget() const;
+        bool isCompressed() const;
+
+    private:
+        struct Entry {
+            TileCacheKey key;
+            UniqueRaster raster; //nullptr when compressed
+            std::shared_ptr<const std::vector<uint8_t>> encoded;
+            GDALDataType dataType;
+            Resolution resolution;
+            size_t byteSize;
+            size_t decodedByteSize;
+        };
+
+        /**
+         * Evicts least recently used tiles until additionalBytes fit into the budget.
+         */
+        void evict(size_t additionalBytes);
+
+        //most recently used tile first.
+        std::list<Entry> entries;
+        std::unordered_map<TileCacheKey, std::list<Entry>::iterator, TileCacheKeyHash> index;
+        size_t byteBudget;
+        size_t byteSize;
+        size_t decodedByteSize;
+        bool compress;
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        mutable std::mutex mutex;
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_TILE_CACHE_H
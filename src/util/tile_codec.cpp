@@ -0,0 +1,162 @@
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include "util/tile_codec.h"
+#include "datatypes/raster_operations.h"
+
+using namespace rts;
+
+namespace {
+
+    enum Method : uint8_t {
+        Raw = 0,
+        Shuffled = 1
+    };
+
+    //control bytes below 128 start literals of (control + 1) bytes, the others a run of one byte.
+    constexpr size_t MAX_LITERAL = 128;
+    constexpr size_t MIN_RUN = 3;
+    constexpr size_t MAX_RUN = 127 + MIN_RUN;
+
+    template<size_t N> struct UnsignedOfSize;
+    template<> struct UnsignedOfSize<1> { using type = uint8_t; };
+    template<> struct UnsignedOfSize<2> { using type = uint16_t; };
+    template<> struct UnsignedOfSize<4> { using type = uint32_t; };
+    template<> struct UnsignedOfSize<8> { using type = uint64_t; };
+
+    template<class T>
+    struct ShuffleEncoder {
+        static void rasterOperation(TypedRaster<T> *raster, std::vector<uint8_t> *shuffled) {
+            using U = typename UnsignedOfSize<sizeof(T)>::type;
+            const auto length = static_cast<size_t>(raster->getDataLength());
+            const T *in = raster->getDataPointer();
+            shuffled->resize(length * sizeof(T));
+            uint8_t *out = shuffled->data();
+
+            U previous = 0;
+            for(size_t i = 0; i < length; ++i){
+                U bits;
+                std::memcpy(&bits, in + i, sizeof(T));
+                U delta = std::is_floating_point<T>::value ? static_cast<U>(bits ^ previous) : static_cast<U>(bits - previous);
+                previous = bits;
+                for(size_t b = 0; b < sizeof(T); ++b)
+                    out[b * length + i] = static_cast<uint8_t>(delta >> (8 * b));
+            }
+        }
+    };
+
+    template<class T>
+    struct ShuffleDecoder {
+        static void rasterOperation(TypedRaster<T> *raster, const uint8_t *shuffled) {
+            using U = typename UnsignedOfSize<sizeof(T)>::type;
+            const auto length = static_cast<size_t>(raster->getDataLength());
+            T *out = raster->getDataPointer();
+
+            U previous = 0;
+            for(size_t i = 0; i < length; ++i){
+                U delta = 0;
+                for(size_t b = 0; b < sizeof(T); ++b)
+                    delta |= static_cast<U>(static_cast<U>(shuffled[b * length + i]) << (8 * b));
+                U bits = std::is_floating_point<T>::value ? static_cast<U>(delta ^ previous) : static_cast<U>(delta + previous);
+                previous = bits;
+                std::memcpy(out + i, &bits, sizeof(T));
+            }
+        }
+    };
+
+    /**
+     * Appends the run length encoding of the bytes to out.
+     * @return false, when the encoding got bigger than limit bytes and was aborted.
+     */
+    bool runLengthEncode(const uint8_t *in, size_t size, std::vector<uint8_t> &out, size_t limit) {
+        size_t literalStart = 0;
+        auto appendLiterals = [&](size_t end){
+            while(literalStart < end){
+                size_t length = std::min(end - literalStart, MAX_LITERAL);
+                out.push_back(static_cast<uint8_t>(length - 1));
+                out.insert(out.end(), in + literalStart, in + literalStart + length);
+                literalStart += length;
+            }
+        };
+
+        size_t pos = 0;
+        while(pos < size){
+            size_t run = 1;
+            while(pos + run < size && run < MAX_RUN && in[pos + run] == in[pos])
+                ++run;
+            if(run >= MIN_RUN){
+                appendLiterals(pos);
+                out.push_back(static_cast<uint8_t>(MAX_LITERAL + run - MIN_RUN));
+                out.push_back(in[pos]);
+                literalStart = pos + run;
+            }
+            pos += run;
+            if(out.size() >= limit)
+                return false;
+        }
+        appendLiterals(size);
+        return out.size() < limit;
+    }
+
+    bool runLengthDecode(const uint8_t *in, size_t size, uint8_t *out, size_t outSize) {
+        size_t pos = 0;
+        size_t written = 0;
+        while(pos < size){
+            uint8_t control = in[pos++];
+            if(control < MAX_LITERAL){
+                size_t length = control + 1u;
+                if(pos + length > size || written + length > outSize)
+                    return false;
+                std::memcpy(out + written, in + pos, length);
+                pos += length;
+                written += length;
+            } else {
+                size_t length = control - MAX_LITERAL + MIN_RUN;
+                if(pos >= size || written + length > outSize)
+                    return false;
+                std::memset(out + written, in[pos++], length);
+                written += length;
+            }
+        }
+        return written == outSize;
+    }
+
+}
+
+void TileCodec::encode(Raster *raster, std::vector<uint8_t> &encoded) {
+    static thread_local std::vector<uint8_t> shuffled;
+    RasterOperations::callUnary<ShuffleEncoder>(raster, &shuffled);
+
+    encoded.clear();
+    encoded.push_back(Method::Shuffled);
+    //one byte for the method is needed in any case, so the encoding must save at least one more byte.
+    if(!runLengthEncode(shuffled.data(), shuffled.size(), encoded, shuffled.size() + 1)){
+        auto data = static_cast<const uint8_t*>(raster->getVoidDataPointer());
+        encoded.assign(1, Method::Raw);
+        encoded.insert(encoded.end(), data, data + shuffled.size());
+    }
+    //the encoded data is usually kept in a cache, so the unused capacity would be wasted.
+    encoded.shrink_to_fit();
+}
+
+void TileCodec::decode(const uint8_t *encoded, size_t encodedSize, Raster *raster) {
+    const size_t size = static_cast<size_t>(raster->getDataLength()) * raster->sizeOfDataType();
+    if(encodedSize == 0)
+        throw std::runtime_error("TileCodec: encoded tile is empty.");
+
+    if(encoded[0] == Method::Raw){
+        if(encodedSize - 1 != size)
+            throw std::runtime_error("TileCodec: size of the raw tile does not match the raster.");
+        std::memcpy(raster->getVoidDataPointer(), encoded + 1, size);
+    } else if(encoded[0] == Method::Shuffled){
+        static thread_local std::vector<uint8_t> shuffled;
+        shuffled.resize(size);
+        if(!runLengthDecode(encoded + 1, encodedSize - 1, shuffled.data(), size))
+            throw std::runtime_error("TileCodec: encoded tile is corrupt or does not match the raster.");
+        RasterOperations::callUnary<ShuffleDecoder>(raster, static_cast<const uint8_t*>(shuffled.data()));
+    } else {
+        throw std::runtime_error("TileCodec: unknown encoding of tile.");
+    }
+}
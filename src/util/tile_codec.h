@@ -0,0 +1,37 @@
+
+#ifndef RASTER_TIME_SERIES_TILE_CODEC_H
+#define RASTER_TIME_SERIES_TILE_CODEC_H
+
+#include <vector>
+#include <cstdint>
+#include "datatypes/raster.h"
+
+namespace rts {
+
+    /**
+     * Fast lossless encoding of the data of a tile, used to keep more tiles in memory caches.
+     * The encoding is chosen by the data type of the raster: integer rasters store the difference to the previous
+     * cell, floating point rasters the xor with the bits of the previous cell. Then the bytes of the cells are
+     * shuffled, so all first bytes are stored together, all second bytes, and so on. Neighbouring cells of real
+     * rasters have similar values, so the upper bytes are mostly zero afterwards and are compressed well by the
+     * following run length encoding.
+     * When the encoding would not be smaller than the raw data, the raw data is stored instead.
+     */
+    class TileCodec {
+    public:
+        /**
+         * Encodes the data of the raster into encoded, replacing its content.
+         */
+        static void encode(Raster *raster, std::vector<uint8_t> &encoded);
+
+        /**
+         * Decodes the data into the raster, which must have the data type and resolution of the encoded raster.
+         * The intermediate shuffled bytes are written to a buffer that is reused by all calls of a thread, so decoding
+         * does not allocate memory besides the raster. Throws a std::runtime_error when the data is corrupt.
+         */
+        static void decode(const uint8_t *encoded, size_t encodedSize, Raster *raster);
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_TILE_CODEC_H
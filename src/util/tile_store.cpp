@@ -0,0 +1,122 @@
+
+#include <fstream>
+#include <cstring>
+#include <boost/filesystem.hpp>
+#include "util/tile_store.h"
+
+using namespace rts;
+
+TileStore::TileStore(size_t memoryBudget, const std::string &directory)
+        : memoryBudget(memoryBudget), baseDirectory(directory), byteSize(0), memoryByteSize(0)
+{
+
+}
+
+TileStore::~TileStore() {
+    if(!directory.empty()){
+        boost::system::error_code ec;
+        boost::filesystem::remove_all(directory, ec);
+    }
+}
+
+void TileStore::put(uint32_t tileIndex, double time, Raster *raster) {
+    size_t size = static_cast<size_t>(raster->getDataLength()) * raster->sizeOfDataType();
+    auto &tileEntries = entries[tileIndex];
+    auto it = tileEntries.find(time);
+    if(it != tileEntries.end()){
+        byteSize -= it->second.byteSize;
+        if(it->second.raster != nullptr)
+            memoryByteSize -= it->second.byteSize;
+    }
+
+    Entry entry;
+    entry.dataType = raster->getDataType();
+    entry.resolution = raster->getResolution();
+    entry.byteSize = size;
+    if(memoryByteSize + size > memoryBudget){
+        if(directory.empty()){
+            boost::filesystem::path p(baseDirectory.empty() ? boost::filesystem::temp_directory_path() : boost::filesystem::path(baseDirectory));
+            p /= boost::filesystem::unique_path("rts_tile_store_%%%%-%%%%-%%%%");
+            boost::filesystem::create_directories(p);
+            directory = p.string();
+        }
+        std::ofstream file(filePath(tileIndex, time), std::ios::binary | std::ios::trunc);
+        file.write(static_cast<const char*>(raster->getVoidDataPointer()), size);
+        if(!file)
+            throw std::runtime_error("TileStore: could not write tile to " + filePath(tileIndex, time));
+    } else {
+        if(it != tileEntries.end() && it->second.raster == nullptr){
+            boost::system::error_code ec;
+            boost::filesystem::remove(filePath(tileIndex, time), ec);
+        }
+        entry.raster = Raster::createRaster(entry.dataType, entry.resolution);
+        std::memcpy(entry.raster->getVoidDataPointer(), raster->getVoidDataPointer(), size);
+        memoryByteSize += size;
+    }
+    tileEntries[time] = std::move(entry);
+    byteSize += size;
+}
+
+UniqueRaster TileStore::get(uint32_t tileIndex, double time) const {
+    auto tileIt = entries.find(tileIndex);
+    if(tileIt == entries.end())
+        return nullptr;
+    auto it = tileIt->second.find(time);
+    if(it == tileIt->second.end())
+        return nullptr;
+    return load(tileIndex, time, it->second);
+}
+
+bool TileStore::findLatestBefore(uint32_t tileIndex, double beforeTime, double &foundTime) const {
+    auto tileIt = entries.find(tileIndex);
+    if(tileIt == entries.end())
+        return false;
+    auto it = tileIt->second.lower_bound(beforeTime);
+    if(it == tileIt->second.begin())
+        return false;
+    --it;
+    foundTime = it->first;
+    return true;
+}
+
+void TileStore::clear() {
+    for(auto &tileEntries : entries){
+        for(auto &entry : tileEntries.second){
+            if(entry.second.raster == nullptr){
+                boost::system::error_code ec;
+                boost::filesystem::remove(filePath(tileEntries.first, entry.first), ec);
+            }
+        }
+    }
+    entries.clear();
+    byteSize = 0;
+    memoryByteSize = 0;
+}
+
+size_t TileStore::getByteSize() const {
+    return byteSize;
+}
+
+size_t TileStore::getMemoryByteSize() const {
+    return memoryByteSize;
+}
+
+UniqueRaster TileStore::load(uint32_t tileIndex, double time, const Entry &entry) const {
+    UniqueRaster raster = Raster::createRaster(entry.dataType, entry.resolution);
+    size_t size = static_cast<size_t>(raster->getDataLength()) * raster->sizeOfDataType();
+    if(entry.raster == nullptr){
+        std::ifstream file(filePath(tileIndex, time), std::ios::binary);
+        file.read(static_cast<char*>(raster->getVoidDataPointer()), size);
+        if(!file)
+            throw std::runtime_error("TileStore: could not read tile from " + filePath(tileIndex, time));
+    } else {
+        std::memcpy(raster->getVoidDataPointer(), entry.raster->getVoidDataPointer(), size);
+    }
+    return raster;
+}
+
+std::string TileStore::filePath(uint32_t tileIndex, double time) const {
+    boost::filesystem::path p(directory);
+    p /= std::to_string(tileIndex) + "_" + std::to_string(static_cast<int64_t>(time)) + ".tile";
+    return p.string();
+}
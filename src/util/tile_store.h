@@ -0,0 +1,85 @@
+
+#ifndef RASTER_TIME_SERIES_TILE_STORE_H
+#define RASTER_TIME_SERIES_TILE_STORE_H
+
+#include <map>
+#include <string>
+#include "datatypes/raster.h"
+
+namespace rts {
+
+    /**
+     * Stores copies of tiles, identified by their tile index and a time, for operators that need to keep intermediate
+     * results, e.g. checkpoints of a cumulative sum. The tiles are kept in memory until the memory budget is used up,
+     * further tiles are spilled to files in a new sub directory of the directory, that is created with the first
+     * spilled tile and removed again when the store is destructed.
+     * Storing a tile for an existing key overwrites it.
+     */
+    class TileStore {
+    public:
+        /**
+         * @param memoryBudget Bytes of tile data kept in memory, 0 writes all tiles to disk.
+         * @param directory Directory for spilling the tiles to disk. When empty the temp directory of the system is used.
+         */
+        TileStore(size_t memoryBudget, const std::string &directory);
+        ~TileStore();
+        TileStore(const TileStore &other) = delete;
+        TileStore& operator=(const TileStore &other) = delete;
+
+        /**
+         * Stores a copy of the raster.
+         */
+        void put(uint32_t tileIndex, double time, Raster *raster);
+
+        /**
+         * @return A copy of the stored raster or nullptr, if there is no raster for the key.
+         */
+        UniqueRaster get(uint32_t tileIndex, double time) const;
+
+        /**
+         * Finds the stored raster of the tile with the latest time that is smaller than beforeTime, without loading it.
+         * @param tileIndex The tile index of the raster.
+         * @param beforeTime Exclusive upper bound for the time of the raster.
+         * @param foundTime Set to the time of the found raster.
+         * @return If a raster is stored for the tile before the time.
+         */
+        bool findLatestBefore(uint32_t tileIndex, double beforeTime, double &foundTime) const;
+
+        /**
+         * Removes all stored rasters.
+         */
+        void clear();
+
+        /**
+         * @return The size of the data of all stored rasters in bytes.
+         */
+        size_t getByteSize() const;
+
+        /**
+         * @return The size of the data of the rasters kept in memory in bytes.
+         */
+        size_t getMemoryByteSize() const;
+
+    private:
+        struct Entry {
+            UniqueRaster raster; //nullptr when stored on disk
+            GDALDataType dataType;
+            Resolution resolution;
+            size_t byteSize;
+        };
+
+        UniqueRaster load(uint32_t tileIndex, double time, const Entry &entry) const;
+        std::string filePath(uint32_t tileIndex, double time) const;
+
+        size_t memoryBudget;
+        std::string baseDirectory;
+        //the sub directory of baseDirectory, empty until the first tile is spilled.
+        std::string directory;
+        std::map<uint32_t, std::map<double, Entry>> entries;
+        size_t byteSize;
+        size_t memoryByteSize;
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_TILE_STORE_H
@@ -0,0 +1,218 @@
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <boost/filesystem.hpp>
+#include "util/time_cube.h"
+
+using namespace rts;
+
+namespace {
+
+    const char timeCubeMagic[8] = {'R', 'T', 'S', 'C', 'U', 'B', 'E', '1'};
+    constexpr uint64_t TILE_ALIGNMENT = 64;
+
+    //magic, data type, tile resolution, first tile, tile count, chunk size, raster count, origin, scale and nodata.
+    constexpr size_t headerSize = sizeof(timeCubeMagic) + sizeof(int32_t) + 8 * sizeof(uint32_t) + 5 * sizeof(double);
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    template<class T>
+    void readValue(const char *&pos, T &value) {
+        std::memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+    }
+
+    template<class T>
+    void writeValue(std::ofstream &file, const T &value) {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    /**
+     * Raster using the data of a mapped tile, the mapping is removed with the raster.
+     */
+    template<class T>
+    class MappedTileRaster : public TypedRaster<T> {
+    public:
+        MappedTileRaster(GDALDataType dataType, Resolution res, std::unique_ptr<MappedRegion> &&region)
+                : TypedRaster<T>(dataType, res, region->getData()), region(std::move(region))
+        {
+
+        }
+
+    private:
+        std::unique_ptr<MappedRegion> region;
+    };
+
+    UniqueRaster createMappedTileRaster(GDALDataType dataType, Resolution res, std::unique_ptr<MappedRegion> &&region) {
+        switch(dataType){
+            case GDT_Byte:
+                return std::make_unique<MappedTileRaster<uint8_t>>(dataType, res, std::move(region));
+            case GDT_UInt16:
+                return std::make_unique<MappedTileRaster<uint16_t>>(dataType, res, std::move(region));
+            case GDT_Int16:
+                return std::make_unique<MappedTileRaster<int16_t>>(dataType, res, std::move(region));
+            case GDT_UInt32:
+                return std::make_unique<MappedTileRaster<uint32_t>>(dataType, res, std::move(region));
+            case GDT_Int32:
+                return std::make_unique<MappedTileRaster<int32_t>>(dataType, res, std::move(region));
+            case GDT_Float32:
+                return std::make_unique<MappedTileRaster<float>>(dataType, res, std::move(region));
+            case GDT_Float64:
+                return std::make_unique<MappedTileRaster<double>>(dataType, res, std::move(region));
+            default:
+                throw std::runtime_error("Unsupported data type for raster creation.");
+        }
+    }
+
+}
+
+size_t TimeCubeLayout::tileByteSize() const {
+    return static_cast<size_t>(tileRes.resX) * tileRes.resY * GDALGetDataTypeSizeBytes(dataType);
+}
+
+uint64_t TimeCubeLayout::dataOffset() const {
+    return alignUp(headerSize + times.size() * 2 * sizeof(double), TILE_ALIGNMENT);
+}
+
+uint64_t TimeCubeLayout::tileOffset(uint32_t tileIndex, uint32_t timeIndex) const {
+    //the last chunk may have less rasters.
+    uint64_t chunkStart = timeIndex - timeIndex % chunkTimesteps;
+    uint64_t chunkLength = std::min<uint64_t>(chunkTimesteps, times.size() - chunkStart);
+    uint64_t tiles = static_cast<uint64_t>(tileCount.resX) * tileCount.resY;
+    uint64_t position = chunkStart * tiles + tileIndex * chunkLength + (timeIndex - chunkStart);
+    return dataOffset() + position * alignUp(tileByteSize(), TILE_ALIGNMENT);
+}
+
+uint64_t TimeCubeLayout::fileSize() const {
+    uint64_t tiles = static_cast<uint64_t>(tileCount.resX) * tileCount.resY;
+    return dataOffset() + tiles * times.size() * alignUp(tileByteSize(), TILE_ALIGNMENT);
+}
+
+int TimeCubeLayout::findTime(double time) const {
+    auto it = std::lower_bound(times.begin(), times.end(), time, [](const TemporalReference &t, double value){
+        return t.t1 < value;
+    });
+    if(it == times.end() || it->t1 != time)
+        return -1;
+    return static_cast<int>(it - times.begin());
+}
+
+std::shared_ptr<const TimeCube> TimeCube::open(const std::string &path) {
+    static std::mutex openMutex;
+    static std::map<std::string, std::weak_ptr<const TimeCube>> openCubes;
+
+    std::lock_guard<std::mutex> lock(openMutex);
+    std::string absolutePath = boost::filesystem::absolute(path).string();
+    auto cube = openCubes[absolutePath].lock();
+    if(cube == nullptr){
+        cube = std::make_shared<const TimeCube>(absolutePath);
+        openCubes[absolutePath] = cube;
+    }
+    return cube;
+}
+
+TimeCube::TimeCube(const std::string &path) : file(path) {
+    if(file.getSize() < headerSize || std::memcmp(file.getData(), timeCubeMagic, sizeof(timeCubeMagic)) != 0)
+        throw std::runtime_error("TimeCube: no time cube file " + path);
+
+    const char *pos = file.getData() + sizeof(timeCubeMagic);
+    int32_t dataType = 0;
+    uint32_t timeCount = 0;
+    readValue(pos, dataType);
+    readValue(pos, layout.tileRes.resX);
+    readValue(pos, layout.tileRes.resY);
+    readValue(pos, layout.firstTile.resX);
+    readValue(pos, layout.firstTile.resY);
+    readValue(pos, layout.tileCount.resX);
+    readValue(pos, layout.tileCount.resY);
+    readValue(pos, layout.chunkTimesteps);
+    readValue(pos, timeCount);
+    readValue(pos, layout.origin.x);
+    readValue(pos, layout.origin.y);
+    readValue(pos, layout.scale.x);
+    readValue(pos, layout.scale.y);
+    readValue(pos, layout.nodata);
+    layout.dataType = static_cast<GDALDataType>(dataType);
+    if(layout.chunkTimesteps == 0)
+        throw std::runtime_error("TimeCube: invalid header of file " + path);
+
+    if(file.getSize() < headerSize + 2 * sizeof(double) * static_cast<uint64_t>(timeCount))
+        throw std::runtime_error("TimeCube: file is not complete " + path);
+    layout.times.reserve(timeCount);
+    for(uint32_t i = 0; i < timeCount; ++i){
+        double t1 = 0, t2 = 0;
+        readValue(pos, t1);
+        readValue(pos, t2);
+        layout.times.emplace_back(t1, t2);
+    }
+
+    if(file.getSize() < layout.fileSize())
+        throw std::runtime_error("TimeCube: file is not complete " + path);
+}
+
+const TimeCubeLayout& TimeCube::getLayout() const {
+    return layout;
+}
+
+UniqueRaster TimeCube::readTile(uint32_t tileIndex, uint32_t timeIndex) const {
+    if(tileIndex >= layout.tileCount.resX * layout.tileCount.resY || timeIndex >= layout.times.size())
+        throw std::runtime_error("TimeCube: tile is not in the cube");
+
+    uint64_t offset = layout.tileOffset(tileIndex, timeIndex);
+    auto region = file.mapPrivate(offset, layout.tileByteSize());
+    if(region != nullptr)
+        return createMappedTileRaster(layout.dataType, layout.tileRes, std::move(region));
+
+    //e.g. the limit of mappings of the process is reached, fall back to a copy from the mapping of the whole file.
+    UniqueRaster raster = Raster::createRaster(layout.dataType, layout.tileRes);
+    std::memcpy(raster->getVoidDataPointer(), file.getData() + offset, layout.tileByteSize());
+    return raster;
+}
+
+TimeCubeWriter::TimeCubeWriter(const std::string &path, const TimeCubeLayout &layout)
+        : layout(layout), file(path, std::ios::binary | std::ios::trunc), path(path)
+{
+    if(!file)
+        throw std::runtime_error("TimeCubeWriter: could not create file " + path);
+
+    file.write(timeCubeMagic, sizeof(timeCubeMagic));
+    writeValue(file, static_cast<int32_t>(layout.dataType));
+    writeValue(file, layout.tileRes.resX);
+    writeValue(file, layout.tileRes.resY);
+    writeValue(file, layout.firstTile.resX);
+    writeValue(file, layout.firstTile.resY);
+    writeValue(file, layout.tileCount.resX);
+    writeValue(file, layout.tileCount.resY);
+    writeValue(file, layout.chunkTimesteps);
+    writeValue(file, static_cast<uint32_t>(layout.times.size()));
+    writeValue(file, layout.origin.x);
+    writeValue(file, layout.origin.y);
+    writeValue(file, layout.scale.x);
+    writeValue(file, layout.scale.y);
+    writeValue(file, layout.nodata);
+    for(const TemporalReference &time : layout.times){
+        writeValue(file, time.t1);
+        writeValue(file, time.t2);
+    }
+    file.flush();
+    if(!file)
+        throw std::runtime_error("TimeCubeWriter: could not write file " + path);
+
+    //tiles that are not written stay zero, the file has its full size in any case.
+    boost::filesystem::resize_file(path, layout.fileSize());
+}
+
+void TimeCubeWriter::write(uint32_t tileIndex, uint32_t timeIndex, Raster *raster) {
+    if(raster->getDataType() != layout.dataType || !raster->getResolution().equalsResolution(layout.tileRes))
+        throw std::runtime_error("TimeCubeWriter: raster does not match the layout of the cube");
+
+    file.seekp(static_cast<std::streamoff>(layout.tileOffset(tileIndex, timeIndex)));
+    file.write(static_cast<const char*>(raster->getVoidDataPointer()), layout.tileByteSize());
+    if(!file)
+        throw std::runtime_error("TimeCubeWriter: could not write file " + path);
+}
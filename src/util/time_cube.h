@@ -0,0 +1,116 @@
+
+#ifndef RASTER_TIME_SERIES_TIME_CUBE_H
+#define RASTER_TIME_SERIES_TIME_CUBE_H
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "datatypes/raster.h"
+#include "datatypes/spatial_temporal_reference.h"
+#include "util/mapped_file.h"
+
+namespace rts {
+
+    /**
+     * Describes the tiles of a time cube file: which tiles of the world tile grid of a projection and which rasters
+     * of a time series it contains, and where every tile is stored in the file.
+     *
+     * The file starts with a header of the layout, followed by the start and end time of every raster. The tiles
+     * follow at dataOffset(), every tile is stored uncompressed at a 64 byte aligned position. The rasters are grouped
+     * into chunks of chunkTimesteps consecutive rasters. Inside of a chunk all rasters of a tile follow each other,
+     * tile after tile. So a temporal scan of a tile reads chunkTimesteps tiles in one go, and a spatial scan of a
+     * raster reads every tile from the same chunk.
+     */
+    struct TimeCubeLayout {
+        GDALDataType dataType;
+        Resolution tileRes;
+        //position of the first tile in the world tile grid, i.e. world pixel divided by tileRes.
+        Resolution firstTile;
+        Resolution tileCount;
+        uint32_t chunkTimesteps;
+        Origin origin;
+        Scale scale;
+        double nodata;
+        //start and end of every raster, sorted by start time.
+        std::vector<TemporalReference> times;
+
+        size_t tileByteSize() const;
+        uint64_t dataOffset() const;
+
+        /**
+         * @param tileIndex Index of the tile in the tile grid of the cube, row after row.
+         * @param timeIndex Index of the raster in times.
+         * @return The position of the tile in the file.
+         */
+        uint64_t tileOffset(uint32_t tileIndex, uint32_t timeIndex) const;
+
+        /**
+         * @return The size of the file with all tiles.
+         */
+        uint64_t fileSize() const;
+
+        /**
+         * @return Index of the raster starting exactly at the time, -1 when there is none.
+         */
+        int findTime(double time) const;
+    };
+
+    /**
+     * Read access to a time cube file, the native storage format for raster time series, see TimeCubeLayout.
+     * The header is read from a mapping of the whole file. Reading a tile maps just the tile again, so the raster
+     * points into the page cache and the data is neither copied nor decoded. The mapping of a tile is private, writing
+     * to the raster copies the written pages and changes neither the file nor other rasters of the tile.
+     * All methods are thread safe.
+     * Use open() to get the cube of a file, it is shared by all users in the process.
+     */
+    class TimeCube {
+    public:
+        /**
+         * @return The cube of the file, shared by all callers in this process.
+         * Throws a std::runtime_error when the file can not be opened or is no complete time cube file.
+         */
+        static std::shared_ptr<const TimeCube> open(const std::string &path);
+
+        explicit TimeCube(const std::string &path);
+        TimeCube(const TimeCube &other) = delete;
+        TimeCube& operator=(const TimeCube &other) = delete;
+
+        const TimeCubeLayout& getLayout() const;
+
+        /**
+         * @return Raster with the mapped tile, a copy of it when the tile can not be mapped.
+         * Throws a std::runtime_error when the tile is not in the cube.
+         */
+        UniqueRaster readTile(uint32_t tileIndex, uint32_t timeIndex) const;
+
+    private:
+        MappedFile file;
+        TimeCubeLayout layout;
+    };
+
+    /**
+     * Writes a time cube file. The header is written when the writer is created, the tiles can be written in any order.
+     * Tiles that are not written are filled with zeros.
+     */
+    class TimeCubeWriter {
+    public:
+        /**
+         * Creates or overwrites the file, throws a std::runtime_error when it can not be written.
+         */
+        TimeCubeWriter(const std::string &path, const TimeCubeLayout &layout);
+
+        /**
+         * Writes the tile, the raster must have the data type and resolution of the layout.
+         */
+        void write(uint32_t tileIndex, uint32_t timeIndex, Raster *raster);
+
+    private:
+        TimeCubeLayout layout;
+        std::ofstream file;
+        std::string path;
+    };
+
+}
+
+#endif //RASTER_TIME_SERIES_TIME_CUBE_H